@@ -20,31 +20,54 @@ Author:
 #include <windows.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include "LibWin324UEFI.h"
 
 extern DWORD _w4udwLastError;
 
-/** __ChkACPISignature()
+/** CloseHandle()
 Synopsis
-    int __ChkACPISignature(char Sig[4]);
+    BOOL CloseHandle([in] HANDLE hObject);
+    https://docs.microsoft.com/en-us/windows/win32/api/handleapi/nf-handleapi-closehandle#syntax
 Description
-    Retrieves the specified firmware table from the firmware table provider.
+    Closes an open object handle.
+    File handles and waitable timers are supported.
+    The underlying FILE is closed with the last handle only, since
+    DuplicateHandle() may have shared it across multiple handles.
 Paramters
-    char Sig[4] :   pointer to signatur
+    https://docs.microsoft.com/en-us/windows/win32/api/handleapi/nf-handleapi-closehandle#parameters
 Returns
-    1   :   found
-    0   :   not found
+    https://docs.microsoft.com/en-us/windows/win32/api/handleapi/nf-handleapi-closehandle#return-value
 **/
 BOOL WINAPI _w4uCloseHandle(_In_ HANDLE hFile)
 {
     W4UFILE* pw4uFile = hFile;
     BOOL fRet = 0;
+    uint64_t tscStart = NULL != _w4uTraceBuf ? __w4uTraceTimestamp() : 0;
     //printf( __FILE__"(%d), "__FUNCTION__"(): " ">>>\n", __LINE__);
 
+    if (W4UTIMER_ID == pw4uFile->signature)            // waitable timer
+        return __w4uCloseTimer((W4UTIMER*)pw4uFile);
+
     if (WIN324UEFI_ID == pw4uFile->signature)
     {
-        fclose(pw4uFile->pFile);
+        if (NULL != pw4uFile->hDir)                     // directory handle
+        {
+            __w4uCloseDirectory(pw4uFile->hDir);
+            free(pw4uFile->pDirNext);
+            free(pw4uFile->pszPath);
+        }
+        else if (0 == --_w4uFileRefCount[_fileno(pw4uFile->pFile)])
+        {                                               // close FILE with the last handle only
+            fclose(pw4uFile->pFile);
+            free(pw4uFile->pszPath);
+        }
+
         pw4uFile->signature = 0ULL;
+        pw4uFile->pFile = NULL;
+        pw4uFile->pszPath = NULL;
+        pw4uFile->hDir = NULL;
+        pw4uFile->pDirNext = NULL;
         fRet = 1;
     }
     else {
@@ -52,6 +75,9 @@ BOOL WINAPI _w4uCloseHandle(_In_ HANDLE hFile)
     }
     //printf( __FILE__"(%d), "__FUNCTION__"(): " "<<<\n", __LINE__);
 
+    if (NULL != _w4uTraceBuf)
+        __w4uTraceRecord(W4UTRACE_CLOSE, pw4uFile, 0, 0, fRet, tscStart, NULL);
+
     return fRet;
 }
 
@@ -23,9 +23,41 @@ Author:
 #include <stdio.h>
 #include <stdint.h>
 #include <io.h>
+#include <string.h>
+#include <stdlib.h>
 #include "LibWin324UEFI.h"
 
-static W4UFILE _w4uiobuf[64/*CDE_FILEV_MAX */];
+W4UFILE _w4uiobuf[W4U_HANDLEV_MAX];
+uint32_t _w4uFileRefCount[W4U_FILEV_MAX];
+
+/** __w4uAllocHandle()
+Synopsis
+    W4UFILE* __w4uAllocHandle(void);
+Description
+    Get a free entry from the handle table.
+    NOTE: Handles are not bound to the file descriptor, since multiple handles
+          may share one single FILE after DuplicateHandle()
+Paramters
+    none
+Returns
+    pointer to free W4UFILE or NULL if handle table is exhausted
+**/
+W4UFILE* __w4uAllocHandle(void)
+{
+    W4UFILE* pRet = NULL;
+    int i;
+
+    for (i = 0; i < W4U_HANDLEV_MAX; i++)
+    {
+        if (WIN324UEFI_ID != _w4uiobuf[i].signature)
+        {
+            pRet = &_w4uiobuf[i];
+            break;
+        }
+    }
+
+    return pRet;
+}
 
 /** CreateFileA()
 Synopsis
@@ -42,6 +74,9 @@ Synopsis
 Description
     Creates or opens a file with a given narrow string filename.
     This implementation does not create an I/O device.
+
+    NOTE: Windows path names are translated to UEFI Shell path names,
+          e.g. C:\work\x.asl -> fs0:\work\x.asl, see __w4uTranslatePath()
 Paramters
     https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-createfilea#parameters
 Returns
@@ -62,8 +97,59 @@ HANDLE WINAPI _w4uCreateFileA(
     int old_errno = errno;                                  // preserve original errno
     int fd;
     W4UFILE* pw4uFile = INVALID_HANDLE_VALUE;
+    char szPath[W4U_MAX_PATH];
+    DWORD dwErr;
+    uint64_t tscStart = NULL != _w4uTraceBuf ? __w4uTraceTimestamp() : 0;
 
     do {
+        //
+        // translate Windows path name to canonical UEFI Shell path name
+        //
+        dwErr = __w4uTranslatePath(lpFileName, szPath, sizeof(szPath));
+
+        if (ERROR_SUCCESS != dwErr) {
+            SetLastError(dwErr);
+            break;
+        }
+        lpFileName = szPath;
+
+        //
+        // open directory handle, FILE_FLAG_BACKUP_SEMANTICS is required as on Windows
+        //
+        if (FILE_FLAG_BACKUP_SEMANTICS & dwFlagsAndAttributes)
+        {
+            void* hDir = __w4uOpenDirectory(szPath);
+
+            if (NULL != hDir)
+            {
+                if (OPEN_EXISTING != dwCreationDisposition && OPEN_ALWAYS != dwCreationDisposition)
+                {
+                    __w4uCloseDirectory(hDir);
+                    SetLastError(CREATE_NEW == dwCreationDisposition ? ERROR_FILE_EXISTS : ERROR_ACCESS_DENIED);
+                    break;
+                }
+
+                pw4uFile = __w4uAllocHandle();
+
+                if (NULL == pw4uFile)
+                {
+                    pw4uFile = INVALID_HANDLE_VALUE;
+                    __w4uCloseDirectory(hDir);
+                    SetLastError(ERROR_TOO_MANY_OPEN_FILES);
+                    break;
+                }
+
+                pw4uFile->signature = WIN324UEFI_ID;
+                pw4uFile->pFile = NULL;
+                pw4uFile->dwDesiredAccess = dwDesiredAccess;
+                pw4uFile->dwCreationDisposition = dwCreationDisposition;
+                pw4uFile->pszPath = _strdup(szPath);
+                pw4uFile->hDir = hDir;
+                pw4uFile->pDirNext = NULL;
+                break;
+            }
+        }
+
         //
         // check invalid dwCreationDisposition
         //
@@ -157,12 +243,26 @@ HANDLE WINAPI _w4uCreateFileA(
 
         if (NULL != fp)
         {
+            W4UFILE* pw4uNew = __w4uAllocHandle();
+
+            if (NULL == pw4uNew)
+            {
+                fclose(fp);
+                SetLastError(ERROR_TOO_MANY_OPEN_FILES);
+                break;
+            }
+
             fd = _fileno(fp);
 
-            pw4uFile = &_w4uiobuf[fd];
+            pw4uFile = pw4uNew;
             pw4uFile->signature = WIN324UEFI_ID;
             pw4uFile->pFile = fp;
             pw4uFile->dwDesiredAccess = dwDesiredAccess;
+            pw4uFile->dwCreationDisposition = dwCreationDisposition;
+            pw4uFile->pszPath = _strdup(szPath);        // for GetFileInformationByHandleEx()
+            pw4uFile->hDir = NULL;
+            pw4uFile->pDirNext = NULL;
+            _w4uFileRefCount[fd] = 1;                   // first handle to that FILE
 
             break;
         }
@@ -173,6 +273,17 @@ HANDLE WINAPI _w4uCreateFileA(
 
     errno = old_errno;                                  // restore original errno
 
+    if (NULL != _w4uTraceBuf && NULL != lpFileName)
+        __w4uTraceRecord(
+            W4UTRACE_CREATE,
+            pw4uFile,
+            (uint32_t)strlen(lpFileName),
+            (uint64_t)dwDesiredAccess << 32 | dwCreationDisposition,
+            INVALID_HANDLE_VALUE != pw4uFile,
+            tscStart,
+            lpFileName
+        );
+
     return (HANDLE)pw4uFile;
 }
 
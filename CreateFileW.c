@@ -25,8 +25,6 @@ Author:
 #include <io.h>
 #include "LibWin324UEFI.h"
 
-static W4UFILE _w4uiobuf[64/*CDE_FILEV_MAX */];
-
 /** CreateFileW()
 Synopsis
     HANDLE CreateFileA(
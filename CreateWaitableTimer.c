@@ -0,0 +1,148 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    CreateWaitableTimer.c
+
+Abstract:
+
+    Win32 API CreateWaitableTimerA()/W() for UEFI
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "LibWin324UEFI.h"
+
+extern DWORD _w4udwLastError;
+
+/** __w4uTimerExpire()
+Synopsis
+    static void __w4uTimerExpire(W4UWHEELNODE* pNode);
+Description
+    Timer wheel expire function, signal the timer and rearm a periodic timer
+Paramters
+    W4UWHEELNODE* pNode : W4UTIMER::Node
+Returns
+    none
+**/
+static void __w4uTimerExpire(W4UWHEELNODE* pNode)
+{
+    W4UTIMER* pTimer = pNode->Context;
+
+    pTimer->fSignaled = 1;
+
+    if (0 != pTimer->Period)
+        __w4uWheelArm(pNode, pNode->Expires + pTimer->Period);   // no drift
+}
+
+/** __w4uCreateTimer()
+Synopsis
+    static HANDLE __w4uCreateTimer(BOOL bManualReset);
+Description
+    Allocate a waitable timer object, not signaled, not armed
+Paramters
+    BOOL bManualReset   : manual-reset or synchronization timer
+Returns
+    handle, NULL on failure
+**/
+static HANDLE __w4uCreateTimer(BOOL bManualReset)
+{
+    W4UTIMER* pTimer = calloc(1, sizeof(W4UTIMER));
+
+    if (NULL == pTimer)
+    {
+        _w4udwLastError = ERROR_NOT_ENOUGH_MEMORY;
+        return NULL;
+    }
+
+    pTimer->signature = W4UTIMER_ID;
+    pTimer->Node.pfnExpire = __w4uTimerExpire;
+    pTimer->Node.Context = pTimer;
+    pTimer->fManualReset = bManualReset;
+
+    return (HANDLE)pTimer;
+}
+
+/** __w4uCloseTimer()
+Synopsis
+    BOOL __w4uCloseTimer(W4UTIMER* pTimer);
+Description
+    Cancel and free a waitable timer, called by CloseHandle()
+Paramters
+    W4UTIMER* pTimer    : timer
+Returns
+    1
+**/
+BOOL __w4uCloseTimer(W4UTIMER* pTimer)
+{
+    __w4uWheelCancel(&pTimer->Node);
+
+    pTimer->signature = 0ULL;
+    free(pTimer);
+
+    return 1;
+}
+
+/** CreateWaitableTimerA()
+Synopsis
+    HANDLE CreateWaitableTimerA(
+      [in, optional] LPSECURITY_ATTRIBUTES lpTimerAttributes,
+      [in]           BOOL                  bManualReset,
+      [in, optional] LPCSTR                lpTimerName
+    );
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-createwaitabletimera#syntax
+Description
+    Creates or opens a waitable timer object.
+
+    NOTE: lpTimerAttributes and lpTimerName are ignored, there is only one single process
+          in the UEFI Shell, each call creates a new timer
+Paramters
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-createwaitabletimera#parameters
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-createwaitabletimera#return-value
+**/
+HANDLE WINAPI _w4uCreateWaitableTimerA(
+    _In_opt_ LPSECURITY_ATTRIBUTES lpTimerAttributes,
+    _In_ BOOL bManualReset,
+    _In_opt_ LPCSTR lpTimerName
+)
+{
+    return __w4uCreateTimer(bManualReset);
+}
+
+/** CreateWaitableTimerW()
+Synopsis
+    HANDLE CreateWaitableTimerW(
+      [in, optional] LPSECURITY_ATTRIBUTES lpTimerAttributes,
+      [in]           BOOL                  bManualReset,
+      [in, optional] LPCWSTR               lpTimerName
+    );
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-createwaitabletimerw#syntax
+Description
+    Creates or opens a waitable timer object, see CreateWaitableTimerA()
+Paramters
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-createwaitabletimerw#parameters
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-createwaitabletimerw#return-value
+**/
+HANDLE WINAPI _w4uCreateWaitableTimerW(
+    _In_opt_ LPSECURITY_ATTRIBUTES lpTimerAttributes,
+    _In_ BOOL bManualReset,
+    _In_opt_ LPCWSTR lpTimerName
+)
+{
+    return __w4uCreateTimer(bManualReset);
+}
+
+void* __imp_CreateWaitableTimerA = (void*)_w4uCreateWaitableTimerA;
+void* __imp_CreateWaitableTimerW = (void*)_w4uCreateWaitableTimerW;
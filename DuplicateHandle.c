@@ -0,0 +1,123 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    DuplicateHandle.c
+
+Abstract:
+
+    Win32 API DuplicateHandle() for UEFI
+
+    Duplicates a file handle. The duplicate shares the underlying FILE,
+    including its buffer and file pointer, with the source handle.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "LibWin324UEFI.h"
+
+extern DWORD _w4udwLastError;
+extern BOOL WINAPI _w4uCloseHandle(HANDLE hFile);
+
+/** DuplicateHandle()
+Synopsis
+    BOOL DuplicateHandle(
+      [in]  HANDLE   hSourceProcessHandle,
+      [in]  HANDLE   hSourceHandle,
+      [in]  HANDLE   hTargetProcessHandle,
+      [out] LPHANDLE lpTargetHandle,
+      [in]  DWORD    dwDesiredAccess,
+      [in]  BOOL     bInheritHandle,
+      [in]  DWORD    dwOptions
+    );
+    https://docs.microsoft.com/en-us/windows/win32/api/handleapi/nf-handleapi-duplicatehandle#syntax
+Description
+    Duplicates an object handle.
+    Only handles from CreateFileA()/CreateFileW() are supported. The FILE is not reopened,
+    instead it's reference count is incremented. CloseHandle() releases the FILE
+    with the last handle.
+
+    NOTE: hSourceProcessHandle, hTargetProcessHandle and bInheritHandle are ignored,
+          there is only one single process in the UEFI Shell.
+Paramters
+    https://docs.microsoft.com/en-us/windows/win32/api/handleapi/nf-handleapi-duplicatehandle#parameters
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/handleapi/nf-handleapi-duplicatehandle#return-value
+**/
+BOOL WINAPI _w4uDuplicateHandle(
+    _In_ HANDLE hSourceProcessHandle,
+    _In_ HANDLE hSourceHandle,
+    _In_ HANDLE hTargetProcessHandle,
+    _Outptr_ LPHANDLE lpTargetHandle,
+    _In_ DWORD dwDesiredAccess,
+    _In_ BOOL bInheritHandle,
+    _In_ DWORD dwOptions
+)
+{
+    W4UFILE* pw4uSrc = hSourceHandle;
+    W4UFILE* pw4uDup = NULL;
+    BOOL fRet = 0;
+
+    do {
+
+        if (NULL == pw4uSrc || INVALID_HANDLE_VALUE == pw4uSrc || WIN324UEFI_ID != pw4uSrc->signature)
+        {
+            _w4udwLastError = ERROR_INVALID_HANDLE;
+            break;
+        }
+
+        if (NULL == pw4uSrc->pFile)                     // directory handles can't be duplicated
+        {
+            _w4udwLastError = ERROR_NOT_SUPPORTED;
+            break;
+        }
+
+        if (NULL == lpTargetHandle)
+        {
+            if (DUPLICATE_CLOSE_SOURCE & dwOptions)     // close only, no duplicate requested
+                fRet = _w4uCloseHandle(hSourceHandle);
+            else
+                _w4udwLastError = ERROR_INVALID_PARAMETER;
+            break;
+        }
+
+        pw4uDup = __w4uAllocHandle();
+
+        if (NULL == pw4uDup)
+        {
+            _w4udwLastError = ERROR_TOO_MANY_OPEN_FILES;
+            break;
+        }
+
+        pw4uDup->signature = WIN324UEFI_ID;
+        pw4uDup->pFile = pw4uSrc->pFile;
+        pw4uDup->pszPath = pw4uSrc->pszPath;           // shared, freed with the last handle
+        pw4uDup->hDir = NULL;
+        pw4uDup->pDirNext = NULL;
+        pw4uDup->dwCreationDisposition = pw4uSrc->dwCreationDisposition;
+        pw4uDup->dwDesiredAccess = (DUPLICATE_SAME_ACCESS & dwOptions) ? pw4uSrc->dwDesiredAccess : (uint32_t)dwDesiredAccess;
+
+        _w4uFileRefCount[_fileno(pw4uSrc->pFile)]++;   // one more handle to that FILE
+
+        *lpTargetHandle = (HANDLE)pw4uDup;
+
+        if (DUPLICATE_CLOSE_SOURCE & dwOptions)
+            _w4uCloseHandle(hSourceHandle);             // FILE kept alive by the duplicate
+
+        fRet = 1;
+
+    } while (0);
+
+    return fRet;
+}
+
+void* __imp_DuplicateHandle = (void*)_w4uDuplicateHandle;
@@ -0,0 +1,41 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    GetCurrentProcess.c
+
+Abstract:
+
+    Win32 API GetCurrentProcess() for UEFI
+
+    Retrieves a pseudo handle for the current process.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+
+/** GetCurrentProcess()
+Synopsis
+    HANDLE GetCurrentProcess();
+    https://docs.microsoft.com/en-us/windows/win32/api/processthreadsapi/nf-processthreadsapi-getcurrentprocess#syntax
+Description
+    Retrieves a pseudo handle for the current process.
+    NOTE: Required by DuplicateHandle() callers. The value is (HANDLE)-1, as on Windows.
+Paramters
+    none
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/processthreadsapi/nf-processthreadsapi-getcurrentprocess#return-value
+**/
+static HANDLE WINAPI _w4uGetCurrentProcess(VOID)
+{
+    return (HANDLE)(LONG_PTR)-1;
+}
+
+void* __imp_GetCurrentProcess = (void*)_w4uGetCurrentProcess;
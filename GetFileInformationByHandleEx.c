@@ -0,0 +1,295 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    GetFileInformationByHandleEx.c
+
+Abstract:
+
+    Win32 API GetFileInformationByHandleEx() for UEFI
+
+    Retrieves file information for the specified file.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "LibWin324UEFI.h"
+
+extern DWORD _w4udwLastError;
+
+#define W4U_DIRINFO_ALIGN(x) (((x) + 7) & ~7)  // LARGE_INTEGER alignment of subsequent entries
+
+/** __w4uGetHandleInfo()
+Synopsis
+    static BOOL __w4uGetHandleInfo(W4UFILE* pw4uFile, W4UFILEINFO* pInfo);
+Description
+    Get the file information of an open file or directory.
+    Pending writes are flushed before, to get the true file size.
+Paramters
+    W4UFILE* pw4uFile   : file handle
+    W4UFILEINFO* pInfo  : file information
+Returns
+    1   :   success
+    0   :   error
+**/
+static BOOL __w4uGetHandleInfo(W4UFILE* pw4uFile, W4UFILEINFO* pInfo)
+{
+    if (NULL != pw4uFile->pFile && ((GENERIC_WRITE | GENERIC_ALL) & pw4uFile->dwDesiredAccess))
+        fflush(pw4uFile->pFile);
+
+    return __w4uGetFileInfoByName(pw4uFile->pszPath, pInfo);
+}
+
+/** __w4uGetDirInfo()
+Synopsis
+    static BOOL __w4uGetDirInfo(W4UFILE* pw4uFile, BOOL fIdBoth, LPVOID lpFileInformation, DWORD dwBufferSize);
+Description
+    Fill the caller's buffer with as many FILE_ID_BOTH_DIR_INFO or FILE_FULL_DIR_INFO entries as fit.
+    An entry that doesn't fit is kept in pw4uFile->pDirNext for the next call.
+Paramters
+    W4UFILE* pw4uFile           : directory handle
+    BOOL fIdBoth                : 1 -> FILE_ID_BOTH_DIR_INFO, 0 -> FILE_FULL_DIR_INFO
+    LPVOID lpFileInformation    : buffer
+    DWORD dwBufferSize          : buffer size
+Returns
+    1   :   at least one entry returned
+    0   :   ERROR_NO_MORE_FILES, ERROR_MORE_DATA (buffer too small for one entry)
+**/
+static BOOL __w4uGetDirInfo(W4UFILE* pw4uFile, BOOL fIdBoth, LPVOID lpFileInformation, DWORD dwBufferSize)
+{
+    size_t offsName = fIdBoth ? offsetof(FILE_ID_BOTH_DIR_INFO, FileName) : offsetof(FILE_FULL_DIR_INFO, FileName);
+    uint8_t* pBuf = lpFileInformation;
+    DWORD* pdwPrevNext = NULL;                          // NextEntryOffset of previous entry
+    size_t offs = 0, sizeEntry;
+    DWORD nEntries = 0;
+    int n;
+
+    if (NULL == pw4uFile->pDirNext)
+    {
+        pw4uFile->pDirNext = malloc(sizeof(W4UFILEINFO));
+
+        if (NULL == pw4uFile->pDirNext) {
+            _w4udwLastError = ERROR_NOT_ENOUGH_MEMORY;
+            return 0;
+        }
+        pw4uFile->pDirNext->FileNameLength = 0;         // no entry read ahead yet
+    }
+
+    while (1)
+    {
+        W4UFILEINFO* pInfo = pw4uFile->pDirNext;
+
+        if (0 == pInfo->FileNameLength)                 // no entry read ahead
+        {
+            n = __w4uReadDirectory(pw4uFile->hDir, pInfo);
+
+            if (1 != n)
+            {
+                if (0 == nEntries)
+                    _w4udwLastError = 0 == n ? ERROR_NO_MORE_FILES : ERROR_INVALID_FUNCTION;
+                break;
+            }
+        }
+
+        sizeEntry = offsName + sizeof(WCHAR) * pInfo->FileNameLength;
+
+        if (offs + sizeEntry > dwBufferSize)            // keep entry for the next call
+        {
+            if (0 == nEntries)
+                _w4udwLastError = ERROR_MORE_DATA;
+            break;
+        }
+
+        if (NULL != pdwPrevNext)
+            *pdwPrevNext = (DWORD)(offs - (pBuf - (uint8_t*)lpFileInformation));
+
+        pBuf = (uint8_t*)lpFileInformation + offs;
+
+        if (fIdBoth)
+        {
+            FILE_ID_BOTH_DIR_INFO* pDirInfo = (void*)pBuf;
+
+            memset(pDirInfo, 0, offsName);
+            pDirInfo->FileIndex = nEntries;
+            pDirInfo->CreationTime.QuadPart = pInfo->CreationTime;
+            pDirInfo->LastAccessTime.QuadPart = pInfo->LastAccessTime;
+            pDirInfo->LastWriteTime.QuadPart = pInfo->LastWriteTime;
+            pDirInfo->ChangeTime.QuadPart = pInfo->LastWriteTime;
+            pDirInfo->EndOfFile.QuadPart = pInfo->EndOfFile;
+            pDirInfo->AllocationSize.QuadPart = pInfo->AllocationSize;
+            pDirInfo->FileAttributes = pInfo->FileAttributes;
+            pDirInfo->FileNameLength = sizeof(WCHAR) * pInfo->FileNameLength;
+            memcpy(pDirInfo->FileName, pInfo->FileName, pDirInfo->FileNameLength);
+            pdwPrevNext = &pDirInfo->NextEntryOffset;
+        }
+        else
+        {
+            FILE_FULL_DIR_INFO* pDirInfo = (void*)pBuf;
+
+            memset(pDirInfo, 0, offsName);
+            pDirInfo->FileIndex = nEntries;
+            pDirInfo->CreationTime.QuadPart = pInfo->CreationTime;
+            pDirInfo->LastAccessTime.QuadPart = pInfo->LastAccessTime;
+            pDirInfo->LastWriteTime.QuadPart = pInfo->LastWriteTime;
+            pDirInfo->ChangeTime.QuadPart = pInfo->LastWriteTime;
+            pDirInfo->EndOfFile.QuadPart = pInfo->EndOfFile;
+            pDirInfo->AllocationSize.QuadPart = pInfo->AllocationSize;
+            pDirInfo->FileAttributes = pInfo->FileAttributes;
+            pDirInfo->FileNameLength = sizeof(WCHAR) * pInfo->FileNameLength;
+            memcpy(pDirInfo->FileName, pInfo->FileName, pDirInfo->FileNameLength);
+            pdwPrevNext = &pDirInfo->NextEntryOffset;
+        }
+
+        pInfo->FileNameLength = 0;                      // entry consumed
+        nEntries++;
+        offs = W4U_DIRINFO_ALIGN(offs + sizeEntry);
+    }
+
+    return 0 != nEntries;
+}
+
+/** GetFileInformationByHandleEx()
+Synopsis
+    BOOL GetFileInformationByHandleEx(
+      [in]  HANDLE                    hFile,
+      [in]  FILE_INFO_BY_HANDLE_CLASS FileInformationClass,
+      [out] LPVOID                    lpFileInformation,
+      [in]  DWORD                     dwBufferSize
+    );
+    https://docs.microsoft.com/en-us/windows/win32/api/winbase/nf-winbase-getfileinformationbyhandleex#syntax
+Description
+    Retrieves file information for the specified file.
+    Supported information classes:
+        FileBasicInfo, FileStandardInfo                         : file and directory handles
+        FileIdBothDirectoryInfo, FileIdBothDirectoryRestartInfo : directory handles
+        FileFullDirectoryInfo, FileFullDirectoryRestartInfo     : directory handles
+    Directory handles are created by CreateFileA()/CreateFileW() with FILE_FLAG_BACKUP_SEMANTICS.
+    The directory information classes return as many entries as fit into lpFileInformation.
+Paramters
+    https://docs.microsoft.com/en-us/windows/win32/api/winbase/nf-winbase-getfileinformationbyhandleex#parameters
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/winbase/nf-winbase-getfileinformationbyhandleex#return-value
+**/
+BOOL WINAPI _w4uGetFileInformationByHandleEx(
+    _In_  HANDLE hFile,
+    _In_  FILE_INFO_BY_HANDLE_CLASS FileInformationClass,
+    _Out_writes_bytes_(dwBufferSize) LPVOID lpFileInformation,
+    _In_  DWORD dwBufferSize
+)
+{
+    W4UFILE* pw4uFile = hFile;
+    W4UFILEINFO Info;
+    BOOL fRet = 0;
+
+    do {
+
+        if (NULL == pw4uFile || INVALID_HANDLE_VALUE == pw4uFile || WIN324UEFI_ID != pw4uFile->signature)
+        {
+            _w4udwLastError = ERROR_INVALID_HANDLE;
+            break;
+        }
+
+        if (NULL == lpFileInformation)
+        {
+            _w4udwLastError = ERROR_INVALID_PARAMETER;
+            break;
+        }
+
+        switch (FileInformationClass)
+        {
+            case FileBasicInfo:
+            {
+                FILE_BASIC_INFO* pBasic = lpFileInformation;
+
+                if (dwBufferSize < sizeof(FILE_BASIC_INFO)) {
+                    _w4udwLastError = ERROR_INSUFFICIENT_BUFFER;
+                    break;
+                }
+
+                if (0 == __w4uGetHandleInfo(pw4uFile, &Info)) {
+                    _w4udwLastError = ERROR_FILE_NOT_FOUND;
+                    break;
+                }
+
+                pBasic->CreationTime.QuadPart = Info.CreationTime;
+                pBasic->LastAccessTime.QuadPart = Info.LastAccessTime;
+                pBasic->LastWriteTime.QuadPart = Info.LastWriteTime;
+                pBasic->ChangeTime.QuadPart = Info.LastWriteTime;
+                pBasic->FileAttributes = Info.FileAttributes;
+                fRet = 1;
+                break;
+            }
+
+            case FileStandardInfo:
+            {
+                FILE_STANDARD_INFO* pStandard = lpFileInformation;
+
+                if (dwBufferSize < sizeof(FILE_STANDARD_INFO)) {
+                    _w4udwLastError = ERROR_INSUFFICIENT_BUFFER;
+                    break;
+                }
+
+                if (0 == __w4uGetHandleInfo(pw4uFile, &Info)) {
+                    _w4udwLastError = ERROR_FILE_NOT_FOUND;
+                    break;
+                }
+
+                pStandard->AllocationSize.QuadPart = Info.AllocationSize;
+                pStandard->EndOfFile.QuadPart = Info.EndOfFile;
+                pStandard->NumberOfLinks = 1;
+                pStandard->DeletePending = 0;
+                pStandard->Directory = 0 != (FILE_ATTRIBUTE_DIRECTORY & Info.FileAttributes);
+                fRet = 1;
+                break;
+            }
+
+            case FileIdBothDirectoryRestartInfo:
+            case FileFullDirectoryRestartInfo:
+            case FileIdBothDirectoryInfo:
+            case FileFullDirectoryInfo:
+            {
+                if (NULL == pw4uFile->hDir) {
+                    _w4udwLastError = ERROR_INVALID_PARAMETER;  // not a directory handle
+                    break;
+                }
+
+                if (FileIdBothDirectoryRestartInfo == FileInformationClass || FileFullDirectoryRestartInfo == FileInformationClass)
+                {
+                    if (NULL != pw4uFile->pDirNext)
+                        pw4uFile->pDirNext->FileNameLength = 0; // drop entry read ahead
+
+                    __w4uRewindDirectory(pw4uFile->hDir);
+                }
+
+                fRet = __w4uGetDirInfo(
+                    pw4uFile,
+                    FileIdBothDirectoryInfo == FileInformationClass || FileIdBothDirectoryRestartInfo == FileInformationClass,
+                    lpFileInformation,
+                    dwBufferSize
+                );
+                break;
+            }
+
+            default:
+                _w4udwLastError = ERROR_INVALID_PARAMETER;
+                break;
+        }
+
+    } while (0);
+
+    return fRet;
+}
+
+void* __imp_GetFileInformationByHandleEx = (void*)_w4uGetFileInformationByHandleEx;
@@ -0,0 +1,44 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    GetLocalTime.c
+
+Abstract:
+
+    Win32 API GetLocalTime() for UEFI
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "LibWin324UEFI.h"
+
+/** GetLocalTime()
+Synopsis
+    void GetLocalTime([out] LPSYSTEMTIME lpSystemTime);
+    https://docs.microsoft.com/en-us/windows/win32/api/sysinfoapi/nf-sysinfoapi-getlocaltime#syntax
+Description
+    Retrieves the current local date and time.
+
+    NOTE:   The local time zone is the EFI_TIME::TimeZone of the RTC, the RTC time itself,
+            if the time zone is unspecified
+Paramters
+    https://docs.microsoft.com/en-us/windows/win32/api/sysinfoapi/nf-sysinfoapi-getlocaltime#parameters
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/sysinfoapi/nf-sysinfoapi-getlocaltime#return-value
+**/
+void WINAPI _w4uGetLocalTime(_Out_ LPSYSTEMTIME lpSystemTime)
+{
+    __w4uFileTimeToSystemTime(__w4uGetLocalFileTime(), lpSystemTime);
+}
+
+void* __imp_GetLocalTime = (void*)_w4uGetLocalTime;
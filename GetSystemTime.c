@@ -0,0 +1,81 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    GetSystemTime.c
+
+Abstract:
+
+    Win32 API GetSystemTime() for UEFI
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "LibWin324UEFI.h"
+
+/** __w4uFileTimeToSystemTime()
+Synopsis
+    void __w4uFileTimeToSystemTime(uint64_t qwFileTime, void* pSystemTime);
+Description
+    Convert FILETIME to SYSTEMTIME, the inverse of the calendar calculation in __w4uEfiTimeToFileTime()
+Paramters
+    uint64_t qwFileTime : 100ns intervals since January 1, 1601
+    void* pSystemTime   : pointer to SYSTEMTIME
+Returns
+    none
+**/
+void __w4uFileTimeToSystemTime(uint64_t qwFileTime, void* pSystemTime)
+{
+    SYSTEMTIME* pst = pSystemTime;
+    int64_t days = (int64_t)(qwFileTime / 864000000000ULL);
+    int64_t secs = (int64_t)(qwFileTime / 10000000ULL % 86400);
+    int64_t z, era, doe, yoe, doy, mp, m;
+
+    //
+    // proleptic gregorian calendar, 400 year eras starting March 1st
+    //
+    z = days + 584694;                                              // 1601-01-01 -> 0000-03-01
+    era = z / 146097;
+    doe = z - era * 146097;                                         // [0, 146096]
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;    // [0, 399]
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);                  // [0, 365]
+    mp = (5 * doy + 2) / 153;                                       // [0, 11], March is 0
+    m = mp < 10 ? mp + 3 : mp - 9;
+
+    pst->wYear = (WORD)(era * 400 + yoe + (m <= 2));
+    pst->wMonth = (WORD)m;
+    pst->wDay = (WORD)(doy - (153 * mp + 2) / 5 + 1);
+    pst->wDayOfWeek = (WORD)((days + 1) % 7);                       // 1601-01-01 was a Monday
+    pst->wHour = (WORD)(secs / 3600);
+    pst->wMinute = (WORD)(secs / 60 % 60);
+    pst->wSecond = (WORD)(secs % 60);
+    pst->wMilliseconds = (WORD)(qwFileTime / 10000 % 1000);
+}
+
+/** GetSystemTime()
+Synopsis
+    void GetSystemTime([out] LPSYSTEMTIME lpSystemTime);
+    https://docs.microsoft.com/en-us/windows/win32/api/sysinfoapi/nf-sysinfoapi-getsystemtime#syntax
+Description
+    Retrieves the current system date and time in Coordinated Universal Time (UTC) format,
+    see GetSystemTimePreciseAsFileTime()
+Paramters
+    https://docs.microsoft.com/en-us/windows/win32/api/sysinfoapi/nf-sysinfoapi-getsystemtime#parameters
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/sysinfoapi/nf-sysinfoapi-getsystemtime#return-value
+**/
+void WINAPI _w4uGetSystemTime(_Out_ LPSYSTEMTIME lpSystemTime)
+{
+    __w4uFileTimeToSystemTime(__w4uGetSystemFileTime(), lpSystemTime);
+}
+
+void* __imp_GetSystemTime = (void*)_w4uGetSystemTime;
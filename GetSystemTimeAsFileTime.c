@@ -0,0 +1,71 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    GetSystemTimeAsFileTime.c
+
+Abstract:
+
+    Win32 API GetSystemTimeAsFileTime() and GetSystemTimePreciseAsFileTime() for UEFI
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "LibWin324UEFI.h"
+
+/** GetSystemTimeAsFileTime()
+Synopsis
+    void GetSystemTimeAsFileTime([out] LPFILETIME lpSystemTimeAsFileTime);
+    https://docs.microsoft.com/en-us/windows/win32/api/sysinfoapi/nf-sysinfoapi-getsystemtimeasfiletime#syntax
+Description
+    Retrieves the current system date and time. The information is in Coordinated Universal Time (UTC) format.
+
+    NOTE:   Same resolution as GetSystemTimePreciseAsFileTime(), the RTC extrapolated by the clock source
+Paramters
+    https://docs.microsoft.com/en-us/windows/win32/api/sysinfoapi/nf-sysinfoapi-getsystemtimeasfiletime#parameters
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/sysinfoapi/nf-sysinfoapi-getsystemtimeasfiletime#return-value
+**/
+void WINAPI _w4uGetSystemTimeAsFileTime(_Out_ LPFILETIME lpSystemTimeAsFileTime)
+{
+    uint64_t qwTime = __w4uGetSystemFileTime();
+
+    lpSystemTimeAsFileTime->dwLowDateTime = (DWORD)qwTime;
+    lpSystemTimeAsFileTime->dwHighDateTime = (DWORD)(qwTime >> 32);
+}
+
+/** GetSystemTimePreciseAsFileTime()
+Synopsis
+    void GetSystemTimePreciseAsFileTime([out] LPFILETIME lpSystemTimeAsFileTime);
+    https://docs.microsoft.com/en-us/windows/win32/api/sysinfoapi/nf-sysinfoapi-getsystemtimepreciseasfiletime#syntax
+Description
+    Retrieves the current system date and time with the highest possible level of precision (<1us).
+    The information is in Coordinated Universal Time (UTC) format.
+
+    NOTE:   The RTC is read once and re-anchored every 60s, in between the time is extrapolated
+            by the clock source, see W4UGetClockSource(), with 100ns resolution.
+            The accuracy is that of the RTC, 1s on most platforms.
+Paramters
+    https://docs.microsoft.com/en-us/windows/win32/api/sysinfoapi/nf-sysinfoapi-getsystemtimepreciseasfiletime#parameters
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/sysinfoapi/nf-sysinfoapi-getsystemtimepreciseasfiletime#return-value
+**/
+void WINAPI _w4uGetSystemTimePreciseAsFileTime(_Out_ LPFILETIME lpSystemTimeAsFileTime)
+{
+    uint64_t qwTime = __w4uGetSystemFileTime();
+
+    lpSystemTimeAsFileTime->dwLowDateTime = (DWORD)qwTime;
+    lpSystemTimeAsFileTime->dwHighDateTime = (DWORD)(qwTime >> 32);
+}
+
+void* __imp_GetSystemTimeAsFileTime = (void*)_w4uGetSystemTimeAsFileTime;
+void* __imp_GetSystemTimePreciseAsFileTime = (void*)_w4uGetSystemTimePreciseAsFileTime;
@@ -0,0 +1,46 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    GetTickCount.c
+
+Abstract:
+
+    Win32 API GetTickCount() for UEFI
+
+    Retrieves the number of milliseconds that have elapsed since the system was started, up to 49.7 days.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdint.h>
+#include "LibWin324UEFI.h"
+
+extern uint64_t __cdecl GetTickCount644UEFI(void);
+
+/** GetTickCount()
+Synopsis
+    DWORD GetTickCount();
+    https://docs.microsoft.com/en-us/windows/win32/api/sysinfoapi/nf-sysinfoapi-gettickcount#syntax
+Description
+    Retrieves the number of milliseconds that have elapsed since the system was started.
+
+    NOTE:   Lower 32 bit of GetTickCount64(), wraps around after 49.7 days
+
+Paramters
+    
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/sysinfoapi/nf-sysinfoapi-gettickcount#return-value
+**/
+uint32_t __cdecl/*EFIAPI*/ GetTickCount4UEFI(void)
+{
+    return (uint32_t)GetTickCount644UEFI();
+}
+
+void* __imp_GetTickCount = (void*)GetTickCount4UEFI;
@@ -21,8 +21,12 @@ Author:
 --*/
 #include <stdint.h>
 #include <time.h>
+#include <intrin.h>
 #include "LibWin324UEFI.h"
 
+static uint64_t _w4uTickEpoch;                  // milliseconds since system start at tick count 0
+static BOOL _w4uTickBootRelative = 1;
+
 /** GetTickCount64()
 Synopsis
     ULONGLONG GetTickCount64();
@@ -30,7 +34,9 @@ Synopsis
 Description
     Retrieves the number of milliseconds that have elapsed since the system was started.
     
-    NOTE:   Actually the number of millioseconds since the process was started.
+    NOTE:   The clock source counter, see W4UGetClockSource(), is scaled by a precomputed
+            fixed point multiplier, for the TSC a read is RDTSC and one multiplication.
+            Since system start by default, since program start with W4USetTickCountBootRelative(0).
 
 Paramters
     
@@ -39,7 +45,40 @@ Returns
 **/
 uint64_t __cdecl/*EFIAPI*/ GetTickCount644UEFI(void)
 {
-    return (uint64_t)clock();
+    if (W4U_CLOCK_TSC == _w4uClockSource)
+        return __umulh(__rdtsc(), _w4uClockMsMul) - _w4uTickEpoch;
+
+    return __w4uClockTickCount() - _w4uTickEpoch;
+}
+
+/** W4USetTickCountBootRelative()
+Synopsis
+    BOOL W4USetTickCountBootRelative(BOOL fEnable);
+Description
+    Select the start of GetTickCount() and GetTickCount64():
+    system start, the TSC reset, as defined by Win32, or program start, as clock() does.
+Paramters
+    BOOL fEnable    : 1 system start, default
+                      0 program start
+Returns
+    previous setting
+**/
+BOOL W4USetTickCountBootRelative(BOOL fEnable)
+{
+    BOOL fPrev = _w4uTickBootRelative;
+
+    _w4uTickBootRelative = fEnable;
+    _w4uTickEpoch = 0;
+
+    if (!fEnable)
+    {
+        uint64_t qwBoot = __w4uClockTickCount();
+        uint64_t qwProgram = (uint64_t)clock() * 1000 / CLOCKS_PER_SEC;
+
+        _w4uTickEpoch = qwBoot > qwProgram ? qwBoot - qwProgram : 0;
+    }
+
+    return fPrev;
 }
 
 void* __imp_GetTickCount64 = (void*)GetTickCount644UEFI;
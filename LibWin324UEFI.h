@@ -23,15 +23,264 @@ Author:
 
 #define WIN324UEFI_ID 0x4946455534323357ULL
 
+#define W4U_FILEV_MAX   64                      /*CDE_FILEV_MAX */
+#define W4U_HANDLEV_MAX (2 * W4U_FILEV_MAX)     // handles incl. DuplicateHandle() duplicates
+#define W4U_MAX_PATH    1024                    // max. length of a translated path name
+#define W4U_MAX_FILENAME 255                    // max. length of a FAT long file name
+
+//
+// file information, converted from EFI_FILE_INFO, time stamps are FILETIME
+//
+typedef struct tagW4UFILEINFO
+{
+    uint64_t    CreationTime;
+    uint64_t    LastAccessTime;
+    uint64_t    LastWriteTime;
+    uint64_t    EndOfFile;
+    uint64_t    AllocationSize;
+    uint32_t    FileAttributes;
+    uint32_t    FileNameLength;                 // number of characters
+    uint16_t    FileName[W4U_MAX_FILENAME + 1];
+
+}W4UFILEINFO;
+
 typedef struct tagW4UFILE
 {
     uint64_t    signature;
     uint32_t    dwDesiredAccess;
     uint32_t    dwCreationDisposition;
-    void*       pFile;
+    void*       pFile;                          // NULL for directory handles
+    char*       pszPath;                        // canonical UEFI Shell path name, shared by duplicates
+    void*       hDir;                           // directory handle, FILE_FLAG_BACKUP_SEMANTICS only
+    W4UFILEINFO* pDirNext;                      // directory entry read ahead, not yet returned
 
 }W4UFILE;
 
+//
+// handle table shared by CreateFileA()/W(), DuplicateHandle() and CloseHandle()
+//
+extern W4UFILE _w4uiobuf[W4U_HANDLEV_MAX];
+extern uint32_t _w4uFileRefCount[W4U_FILEV_MAX];   // number of handles per FILE, indexed by _fileno()
+extern W4UFILE* __w4uAllocHandle(void);
+
+//
+// file I/O trace, recorded to RAM by W4UTraceStart(), written to file by W4UTraceStop() or at exit
+//
+//  trace file layout:  W4UTRACEHDR, W4UTRACEREC[]
+//                      W4UTRACE_CREATE records are followed by the path name,
+//                      zero terminated and padded to a multiple of sizeof(W4UTRACEREC)
+//
+#define W4UTRACE_SIGNATURE  'TU4W'              // "W4UT"
+#define W4UTRACE_VERSION    1
+
+#define W4UTRACE_CREATE     1                   // Size: path name length, Offset: dwDesiredAccess << 32 | dwCreationDisposition, Result: success
+#define W4UTRACE_READ       2                   // Size: bytes requested, Offset: file position before, Result: bytes read
+#define W4UTRACE_WRITE      3                   // Size: bytes requested, Offset: file position before, Result: bytes written
+#define W4UTRACE_SEEK       4                   // Size: dwMoveMethod, Offset: distance to move, Result: new position
+#define W4UTRACE_CLOSE      5                   // Result: success
+
+typedef struct tagW4UTRACEHDR
+{
+    uint32_t    Signature;                      // W4UTRACE_SIGNATURE
+    uint16_t    Version;                        // W4UTRACE_VERSION
+    uint16_t    RecSize;                        // sizeof(W4UTRACEREC)
+    uint32_t    NumRecs;                        // number of W4UTRACEREC incl. path names
+    uint32_t    NumLost;                        // number of calls not recorded due to buffer overflow
+    uint64_t    TscPerSec;                      // TSC frequency
+
+}W4UTRACEHDR;
+
+typedef struct tagW4UTRACEREC
+{
+    uint8_t     Op;                             // W4UTRACE_CREATE ... W4UTRACE_CLOSE
+    uint8_t     Reserved;
+    uint16_t    Handle;                         // index into _w4uiobuf[]
+    uint32_t    Size;
+    uint64_t    Offset;
+    uint64_t    Result;
+    uint64_t    TscStart;
+    uint64_t    TscEnd;
+
+}W4UTRACEREC;
+
+extern void* _w4uTraceBuf;                      // NULL: tracing disabled
+extern uint64_t __w4uTraceTimestamp(void);
+extern void __w4uTraceRecord(uint8_t Op, W4UFILE* pw4uFile, uint32_t Size, uint64_t Offset, uint64_t Result, uint64_t TscStart, const char* pszPath);
+
+//
+// ACPI table index, built on first use by GetSystemFirmwareTable() and EnumSystemFirmwareTables()
+//
+typedef struct tagW4UACPIHASH
+{
+    uint32_t    Signature;                      // 0: empty slot
+    uint32_t    First;                          // first instance in Order[]
+    uint32_t    nInstances;                     // number of tables with that signature
+
+}W4UACPIHASH;
+
+typedef struct tagW4UACPIINDEX
+{
+    void*       pRSDP;
+    void*       pXSDT;
+    void*       pFADT;
+    void*       pDSDT;
+    void*       pFACS;
+    uint32_t    nXsdtTables;                    // tables listed in the XSDT, pTable[0] ... pTable[nXsdtTables - 1]
+    uint32_t    nTables;                        // incl. XSDT, DSDT and FACS
+    uint32_t    nTablesMax;                     // size of pTable[], Order[], Status[] and Stamp[]: XSDT entries + 3
+    void**      pTable;                         // XSDT order
+    uint32_t*   Order;                          // pTable[] indices, grouped by signature, XSDT order within a group
+    uint8_t*    Status;                         // W4UValidateAcpiTable() result | W4U_ACPI_VALIDATED, 0: not yet validated
+    uint64_t*   Stamp;                          // __w4uAcpiStamp() of pTable[] when indexed
+    uint64_t    XsdtStamp;                      // __w4uAcpiStamp() of the XSDT, generation stamp
+    uint32_t    Generation;                     // incremented on each (re)build
+    uint32_t    HashBits;                       // 1 << HashBits slots, at least twice nTablesMax
+    W4UACPIHASH* pHash;                         // NULL: no ACPI or out of memory, empty index
+
+}W4UACPIINDEX;
+
+extern W4UACPIINDEX* __w4uGetAcpiIndex(void);
+extern void* __w4uAcpiFindTable(uint32_t Signature, uint32_t Instance);
+extern uint32_t __w4uAcpiCountTables(uint32_t Signature);
+extern int __w4uAcpiTableIndex(const void* pTable);
+extern void __w4uAcpiIndexReset(void);
+extern void __w4uAcpiIndexInvalidate(void);
+extern uint64_t __w4uAcpiStamp(const void* pTable);
+
+//
+// EFI configuration table used by the firmware table providers, see W4USetFirmwareTableProvider()
+//
+extern void* __w4uGetConfigurationTable(uint32_t* pnEntries);
+
+//
+// ACPI table validation
+//
+#define W4U_ACPI_VALID              0
+#define W4U_ACPI_BAD_CHECKSUM       1
+#define W4U_ACPI_BAD_LENGTH         2
+#define W4U_ACPI_BAD_XSDT_ENTRY     4
+#define W4U_ACPI_VALIDATED          0x80        // W4UACPIINDEX.Status[] only
+
+#define W4U_ACPI_TABLE_MAX_LENGTH   0x1000000   // 16MB, length sanity limit
+
+extern int _w4uAcpiValidation;                  // 1: don't return invalid tables
+extern uint8_t __w4uAcpiChecksum(const void* pData, uint32_t len);
+
+//
+// ACPI 6.2 table signature classification, table IDs are 1 ... W4U_ACPI_SIG_COUNT
+//
+#define W4U_ACPI_SIG_UNKNOWN        0
+#define W4U_ACPI_SIG_COUNT          59
+
+//
+// CPU features
+//
+extern int __w4uHasAvx2(void);
+
+//
+// TSC frequency, determined once, see W4UGetTscFrequency()
+//
+#define W4U_TSC_SOURCE_CPUID15      1           // CPUID 0x15 TSC/crystal ratio and crystal frequency
+#define W4U_TSC_SOURCE_CPUID16      2           // CPUID 0x16 processor base frequency
+#define W4U_TSC_SOURCE_PIT          3           // 8254 PIT channel 2 calibration
+
+extern uint64_t __w4uTscFrequency(void);
+
+//
+// clock source for QueryPerformanceCounter(), GetTickCount64() and Sleep(), see W4UGetClockSource()
+//
+#define W4U_CLOCK_TSC               1
+#define W4U_CLOCK_HPET              2
+#define W4U_CLOCK_PMTIMER           3
+
+typedef uint64_t (*W4UCLOCKIO)(uint32_t AddressSpace, uint64_t Address, uint32_t BitWidth);
+
+extern int _w4uClockSource;                     // W4U_CLOCK_..., 0: not yet selected
+extern uint64_t _w4uClockMsMul;                 // milliseconds per count, 64.64 fixed point
+extern uint64_t __w4uClockRead(void);
+extern uint64_t __w4uClockTickCount(void);
+extern uint64_t __w4uClockTime(void);
+extern uint64_t __w4uClockFrequency(void);
+
+//
+// EFI_TIMER_ARCH_PROTOCOL, timer interrupt period for Sleep() and timeBeginPeriod()
+//
+extern void* __w4uGetTimerArchProtocol(void);
+extern uint64_t __w4uTimerPeriod(void);
+
+//
+// SMBIOS structure index, built on first use by the 'RSMB' firmware table provider
+//
+typedef struct tagW4USMBIOSENTRY
+{
+    const uint8_t* pStruct;                     // formatted area, starts with Type, Length, Handle
+    uint32_t    Size;                           // formatted area and string-set incl. terminating double NUL
+    uint16_t    Handle;
+    uint8_t     Type;
+    uint8_t     nStrings;
+    uint32_t    FirstString;                    // index of the first string offset in W4USMBIOSINDEX.pStringOffset[]
+
+}W4USMBIOSENTRY;
+
+typedef struct tagW4USMBIOSINDEX
+{
+    const void* pTable;                         // structure table, NULL if SMBIOS is not available
+    uint32_t    TableLength;                    // up to and incl. the type 127 end-of-table structure
+    uint8_t     MajorVersion;
+    uint8_t     MinorVersion;
+    uint8_t     DmiRevision;                    // SMBIOS 2.x: EntryPointRevision, 3.x: DocRev
+    uint8_t     fSmbios3;                       // SMBIOS 3.x 64 bit entry point
+    uint32_t    nEntries;
+    W4USMBIOSENTRY* pEntry;                     // structure table order
+    uint32_t*   pStringOffset;                  // string offsets relative to W4USMBIOSENTRY.pStruct
+    uint32_t*   pTypeOrder;                     // pEntry[] indices, grouped by type, table order within a group
+    uint32_t    FirstOfType[256];               // first pTypeOrder[] index per type
+    uint32_t    CountOfType[256];               // number of structures per type
+    uint32_t    HandleHashBits;
+    uint32_t*   pHandleHash;                    // pEntry[] index + 1, 0: empty slot
+    const void* pEntryPoint;                    // SMBIOS 3.x or 2.x entry point
+    uint64_t    Stamp;                          // entry point checksum and table length, generation stamp
+
+}W4USMBIOSINDEX;
+
+extern W4USMBIOSINDEX* __w4uGetSmbiosIndex(void);
+extern uint32_t __w4uSmbiosHandleSlot(W4USMBIOSINDEX* pIndex, uint16_t Handle);
+extern void __w4uSmbiosIndexReset(void);
+extern void __w4uSmbiosIndexInvalidate(void);
+
+//
+// AML named-object index over DSDT and SSDTs, built on first use by W4UAmlFindName()
+//
+#define W4U_AML_NAMES_MAX   0x10000             // upper limit of W4UAMLINDEX.nNames
+#define W4U_AML_NONE        0xFFFFFFFF          // no node
+
+typedef struct tagW4UAMLNAME
+{
+    const void* pTable;                         // DSDT or SSDT that declares the object
+    uint32_t    Offset;                         // offset of the declaring opcode, NamedField: of the NameSeg
+    uint32_t    Parent;                         // W4UAMLINDEX.pName[] index of the parent scope, root: 0
+    uint32_t    NameSeg;                        // e.g. "_PRT", root: 0
+    uint16_t    Opcode;                         // declaring AML opcode, 0x5Bxx for extended opcodes,
+                                                // 0x10 (ScopeOp) for scopes without declaration, e.g. \_SB_
+    uint16_t    Reserved;
+
+}W4UAMLNAME;
+
+typedef struct tagW4UAMLINDEX
+{
+    uint32_t    Generation;                     // W4UACPIINDEX.Generation the index was built from
+    uint32_t    nNames;                         // incl. the root at pName[0]
+    uint32_t    nMax;                           // allocated pName[] entries
+    uint32_t    fTruncated;                     // W4U_AML_NAMES_MAX reached or out of memory
+    W4UAMLNAME* pName;
+    uint32_t    HashBits;
+    uint32_t*   pHash;                          // pName[] index + 1, 0: empty slot, key: Parent and NameSeg
+
+}W4UAMLINDEX;
+
+extern W4UAMLINDEX* __w4uGetAmlIndex(void);
+extern uint32_t __w4uAmlHashSlot(W4UAMLINDEX* pIndex, uint32_t Parent, uint32_t NameSeg);
+
 //
 // Windows equates
 //
@@ -67,4 +316,171 @@ typedef unsigned int* PUINT;
 #define WINBASEAPI DECLSPEC_IMPORT
 #define WINAPI      __stdcall
 
+//
+// Windows path name to UEFI Shell path name translation
+//
+extern DWORD __w4uTranslatePath(const char* pszPath, char* pszBuffer, size_t BufferSize);
+extern BOOL W4USetDriveMapping(char chDrive, const char* pszMapping);
+
+//
+// EFI_SHELL_PROTOCOL based file information and directory access
+//
+extern void* __w4uGetShellProtocol(void);
+extern uint64_t __w4uEfiTimeToFileTime(const void* pTime);
+extern BOOL __w4uGetFileInfoByName(const char* pszPath, W4UFILEINFO* pInfo);
+extern void* __w4uOpenDirectory(const char* pszPath);
+extern void __w4uCloseDirectory(void* hDir);
+extern BOOL __w4uRewindDirectory(void* hDir);
+extern int __w4uReadDirectory(void* hDir, W4UFILEINFO* pInfo);
+
+//
+// timer wheel, driven by one periodic UEFI timer event, see __w4uTimerWheel.c
+//
+#define W4U_WHEEL_LEVELS    4
+
+typedef struct tagW4UWHEELNODE
+{
+    struct tagW4UWHEELNODE* pNext;
+    struct tagW4UWHEELNODE* pPrev;              // NULL: not armed
+    uint64_t    Expires;                        // milliseconds of __w4uClockTickCount()
+    void        (*pfnExpire)(struct tagW4UWHEELNODE* pNode);
+    void*       Context;
+
+}W4UWHEELNODE;
+
+extern size_t __w4uWheelLock(void);
+extern void __w4uWheelUnlock(size_t Tpl);
+extern void __w4uWheelArm(W4UWHEELNODE* pNode, uint64_t qwExpires);
+extern void __w4uWheelCancel(W4UWHEELNODE* pNode);
+extern void __w4uWheelWait(void);
+
+//
+// waitable timer object, created by CreateWaitableTimerA()/W(), closed by CloseHandle()
+//
+#define W4UTIMER_ID 0x52454D4954553457ULL       // "W4UTIMER"
+
+typedef struct tagW4UTIMER
+{
+    uint64_t    signature;                      // W4UTIMER_ID, same offset as W4UFILE::signature
+    W4UWHEELNODE Node;
+    uint32_t    Period;                         // milliseconds, 0: one-shot
+    int         fManualReset;
+    volatile long fSignaled;
+
+}W4UTIMER;
+
+extern BOOL __w4uCloseTimer(W4UTIMER* pTimer);
+
+//
+// system time, RTC anchored to the clock source, see __w4uSystemTime.c
+//
+extern uint64_t __w4uGetSystemFileTime(void);
+extern uint64_t __w4uGetLocalFileTime(void);
+extern void __w4uFileTimeToSystemTime(uint64_t qwFileTime, void* pSystemTime);
+
+//
+// timer interrupt period, lowered by timeBeginPeriod(), see __w4uTimerPeriod()
+//
+#define W4U_TIME_PERIOD_MAX 1000000             // TIMECAPS::wPeriodMax, as reported by Windows, in ms
+extern BOOL __w4uTimerSetPeriod(uint64_t Period);
+
+//
+// firmware tables
+//
+extern uint32_t __cdecl GetSystemFirmwareTable4UEFI(uint32_t FirmwareTableProviderSignature, uint32_t FirmwareTableID, void* pFirmwareTableBuffer, uint32_t BufferSize, ...);
+extern uint32_t EnumSystemFirmwareTables4UEFI(uint32_t FirmwareTableProviderSignature, void* pFirmwareTableEnumBuffer, uint32_t BufferSize);
+extern BOOL W4UGetFirmwareTableView(uint32_t FirmwareTableProviderSignature, uint32_t FirmwareTableID, uint32_t Instance, const void** ppTable, uint32_t* pSize);
+extern uint32_t W4UGetFirmwareTableRange(uint32_t FirmwareTableProviderSignature, uint32_t FirmwareTableID, uint32_t Instance, uint32_t Offset, void* pBuffer, uint32_t BufferSize, uint32_t* pTableSize);
+
+//
+// 'RSMB' header of GetSystemFirmwareTable(), followed by the SMBIOS structure table
+//
+typedef struct _RAWSMBIOSDATA
+{
+    BYTE    Used20CallingMethod;
+    BYTE    SMBIOSMajorVersion;
+    BYTE    SMBIOSMinorVersion;
+    BYTE    DmiRevision;
+    DWORD   Length;
+    BYTE    SMBIOSTableData[];
+}RAWSMBIOSDATA;
+
+typedef struct tagW4UACPIITER
+{
+    uint32_t    Signature;                      // 0: all tables
+    uint32_t    Instance;                       // next instance
+
+}W4UACPIITER;
+
+extern uint32_t W4UValidateAcpiTable(const void* pTable);
+extern BOOL W4USetAcpiValidation(BOOL fEnable);
+
+extern uint32_t W4UAcpiSignatureId(uint32_t Signature);
+extern uint32_t W4UAcpiSignatureName(uint32_t Id);
+extern uint32_t W4UAcpiClassifySignatures(const uint32_t* pSig, uint32_t nSig, uint8_t* pId);
+
+extern uint32_t W4UAcpiTableCount(uint32_t Signature);
+extern void W4UAcpiIterInit(W4UACPIITER* pIter, uint32_t Signature);
+extern BOOL W4UAcpiIterNext(W4UACPIITER* pIter, const void** ppTable, uint32_t* pSize);
+
+//
+// firmware table snapshot, see W4UGetFirmwareSnapshot()
+//
+#define W4U_SNAPSHOT_SIGNATURE 'SU4W'           // "W4US"
+
+typedef struct tagW4USNAPSHOTHDR
+{
+    uint32_t    Signature;                      // W4U_SNAPSHOT_SIGNATURE
+    uint32_t    HeaderSize;                     // header and directory
+    uint32_t    TotalSize;                      // header, directory and table data
+    uint32_t    nEntries;
+    uint8_t     SmbiosMajorVersion;
+    uint8_t     SmbiosMinorVersion;
+    uint8_t     DmiRevision;
+    uint8_t     Reserved[5];
+}W4USNAPSHOTHDR;                                // followed by W4USNAPSHOTENTRY[nEntries]
+
+typedef struct tagW4USNAPSHOTENTRY
+{
+    uint32_t    ProviderSignature;              // 'ACPI' or 'RSMB'
+    uint32_t    Signature;                      // table signature, 0 for 'RSMB'
+    uint32_t    Instance;                       // n-th table of that signature in the snapshot
+    uint32_t    Offset;                         // table data offset from the begin of W4USNAPSHOTHDR
+    uint32_t    Length;
+    uint32_t    Reserved;
+    uint64_t    PhysicalAddress;
+}W4USNAPSHOTENTRY;
+
+extern uint32_t W4UGetFirmwareSnapshot(void* pBuffer, uint32_t BufferSize, void** ppSnapshot);
+
+extern BOOL W4USetFirmwareTableProvider(void* pConfigurationTable, uint32_t nEntries);
+extern BOOL W4UFirmwareCaptureAdd(const char* pszFile);
+extern BOOL W4UFirmwareCaptureAddTable(const void* pTable);
+extern BOOL W4UFirmwareCaptureAddSmbios(const void* pTable, uint32_t Size);
+extern BOOL W4UFirmwareCaptureInstall(void);
+extern void W4UFirmwareCaptureReset(void);
+
+extern uint64_t W4UGetTscFrequency(uint32_t* pSource, uint32_t* pErrorPpm);
+extern BOOL W4USetQpcSerialization(BOOL fEnable);
+extern uint32_t W4UGetClockSource(uint64_t* pFrequency, uint32_t* pReadCostNs);
+extern BOOL W4USetClockSource(uint32_t Source);
+extern W4UCLOCKIO W4USetClockSourceIo(W4UCLOCKIO pfnIo);
+extern BOOL W4USetTickCountBootRelative(BOOL fEnable);
+extern void W4UStall(uint64_t qwMicroseconds);
+
+extern const W4UAMLNAME* W4UAmlFindName(const char* pszPath);
+extern const W4UAMLNAME* W4UAmlGetName(uint32_t Index);
+extern uint32_t W4UAmlGetPath(const W4UAMLNAME* pName, char* pszBuffer, uint32_t BufferSize);
+
+extern uint32_t W4USmbiosCount(uint8_t Type);
+extern const W4USMBIOSENTRY* W4USmbiosFindByType(uint8_t Type, uint32_t Instance);
+extern const W4USMBIOSENTRY* W4USmbiosFindByHandle(uint16_t Handle);
+extern const char* W4USmbiosGetString(const W4USMBIOSENTRY* pEntry, uint8_t StringNumber);
+
+//
+// file I/O trace
+//
+extern BOOL W4UTraceStart(size_t BufferSize, const char* pszTraceFile);
+extern BOOL W4UTraceStop(void);
+
 #endif//_WIN324UEFI_H_
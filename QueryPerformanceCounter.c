@@ -15,6 +15,12 @@ Abstract:
     Retrieves the current value of the performance counter, which is a high resolution (<1us)
     time stamp that can be used for time-interval measurements.
 
+    The performance counter is the counter of the clock source, see W4UGetClockSource(), at full resolution,
+    usually the invariant TSC, the HPET or ACPI PM timer otherwise.
+    In serialized mode, see W4USetQpcSerialization(), the TSC is read by RDTSCP followed by LFENCE,
+    or LFENCE, RDTSC, LFENCE if RDTSCP is not supported, so the counter read can't be reordered
+    with the code being measured.
+
 Author:
 
     Kilian Kegel
@@ -23,10 +29,13 @@ Author:
 
 #include <uefi.h>
 #include <stdint.h>
+#include <intrin.h>
 #include "LibWin324UEFI.h"
 
 #define IsEqualGUID(rguid1, rguid2) (!memcmp(rguid1, rguid2, sizeof(GUID))) //guiddef.h
 
+static int _w4uQpcSerialization;                        // 0: RDTSC, 1: RDTSCP, LFENCE, 2: LFENCE, RDTSC, LFENCE
+
 /** QueryPerformanceCounter()
 Synopsis
     BOOL QueryPerformanceCounter(LARGE_INTEGER *lpPerformanceCount);
@@ -42,11 +51,69 @@ Returns
 **/
 int32_t EFIAPI QueryPerformanceCounter4UEFI(int64_t* lpPerformanceCount)
 {
-    *lpPerformanceCount = __rdtsc() / 1000;
+    unsigned int Aux;
+
+    if (W4U_CLOCK_TSC != _w4uClockSource)
+    {
+        *lpPerformanceCount = (int64_t)__w4uClockRead();    // HPET, PM timer or not yet selected
+        return 1;
+    }
+
+    switch (_w4uQpcSerialization)
+    {
+    case 0:
+        *lpPerformanceCount = (int64_t)__rdtsc();
+        break;
+    case 1:                                                 // RDTSCP waits for all previous instructions
+        *lpPerformanceCount = (int64_t)__rdtscp(&Aux);
+        _mm_lfence();                                       // subsequent instructions wait for RDTSCP
+        break;
+    default:
+        _mm_lfence();
+        *lpPerformanceCount = (int64_t)__rdtsc();
+        _mm_lfence();
+        break;
+    }
 
     return 1;
 }
 
+/** W4USetQpcSerialization()
+Synopsis
+    BOOL W4USetQpcSerialization(BOOL fEnable);
+Description
+    Enable or disable the serialized mode of QueryPerformanceCounter(), for micro benchmarks.
+    A serialized read costs more than a plain RDTSC, W4UBench qpc measures both.
+Paramters
+    BOOL fEnable    : 1 to enable, 0 to disable
+Returns
+    previous setting
+**/
+BOOL W4USetQpcSerialization(BOOL fEnable)
+{
+    BOOL fPrev = 0 != _w4uQpcSerialization;
+    int r[4];
+
+    _w4uQpcSerialization = 0;
+
+    if (fEnable)
+    {
+        _w4uQpcSerialization = 2;
+
+        __cpuid(r, 0x80000000);
+
+        if ((uint32_t)r[0] >= 0x80000001)
+        {
+            __cpuid(r, 0x80000001);
+
+            if (0 != (r[3] & (1 << 27)))                    // RDTSCP
+                _w4uQpcSerialization = 1;
+        }
+    }
+
+    return fPrev;
+}
+
 BOOL WINAPI _w4uQueryPerformanceCounter(
     /*_Out_*/ int64_t* lpPerformanceCount
 ) 
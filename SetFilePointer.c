@@ -61,11 +61,16 @@ static DWORD WINAPI _w4uUEFISetFilePointer(
     int n;
     fpos_t newpos;
     int old_errno = errno;                                  // preserve original errno
+    uint64_t tscStart = NULL != _w4uTraceBuf ? __w4uTraceTimestamp() : 0;
     errno = 0;                                              // clear errno
 
     do {
         if (WIN324UEFI_ID == pw4uFile->signature)
         {
+            if (NULL == pw4uFile->pFile) {                  // directory handle
+                _w4udwLastError = ERROR_INVALID_FUNCTION;
+                break;
+            }
 
             if (NULL != lpDistanceToMoveHigh) 
             {
@@ -101,6 +106,9 @@ static DWORD WINAPI _w4uUEFISetFilePointer(
 
     errno = old_errno;                                      // restore original errno
 
+    if (NULL != _w4uTraceBuf)
+        __w4uTraceRecord(W4UTRACE_SEEK, pw4uFile, (uint32_t)dwMoveMethod, (uint64_t)SeekPtr.pos64, dwRet, tscStart, NULL);
+
     return dwRet;
 }
 
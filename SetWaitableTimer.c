@@ -0,0 +1,137 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    SetWaitableTimer.c
+
+Abstract:
+
+    Win32 API SetWaitableTimer() and CancelWaitableTimer() for UEFI
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "LibWin324UEFI.h"
+
+extern DWORD _w4udwLastError;
+
+/** SetWaitableTimer()
+Synopsis
+    BOOL SetWaitableTimer(
+      [in]           HANDLE              hTimer,
+      [in]           const LARGE_INTEGER *lpDueTime,
+      [in]           LONG                lPeriod,
+      [in, optional] PTIMERAPCROUTINE    pfnCompletionRoutine,
+      [in, optional] LPVOID              lpArgToCompletionRoutine,
+      [in]           BOOL                fResume
+    );
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-setwaitabletimer#syntax
+Description
+    Activates the specified waitable timer. When the due time arrives, the timer is signaled
+    and, if periodic, rearmed relative to the due time.
+
+    NOTE: the timer resolution is the timer interrupt period, see timeBeginPeriod()
+    NOTE: UEFI has no asynchronous procedure calls, pfnCompletionRoutine must be NULL
+    NOTE: fResume succeeds with ERROR_NOT_SUPPORTED, as on systems without resume support
+Paramters
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-setwaitabletimer#parameters
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-setwaitabletimer#return-value
+**/
+BOOL WINAPI _w4uSetWaitableTimer(
+    _In_ HANDLE hTimer,
+    _In_ const LARGE_INTEGER* lpDueTime,
+    _In_ LONG lPeriod,
+    _In_opt_ PTIMERAPCROUTINE pfnCompletionRoutine,
+    _In_opt_ LPVOID lpArgToCompletionRoutine,
+    _In_ BOOL fResume
+)
+{
+    W4UTIMER* pTimer = hTimer;
+    uint64_t qwDelay = 0, qwNow;
+    BOOL fRet = 0;
+
+    do {
+
+        if (NULL == pTimer || INVALID_HANDLE_VALUE == pTimer || W4UTIMER_ID != pTimer->signature)
+        {
+            _w4udwLastError = ERROR_INVALID_HANDLE;
+            break;
+        }
+
+        if (NULL == lpDueTime || lPeriod < 0)
+        {
+            _w4udwLastError = ERROR_INVALID_PARAMETER;
+            break;
+        }
+
+        if (NULL != pfnCompletionRoutine)
+        {
+            _w4udwLastError = ERROR_NOT_SUPPORTED;
+            break;
+        }
+
+        if (lpDueTime->QuadPart < 0)                                // relative, 100ns units
+            qwDelay = (uint64_t)(-lpDueTime->QuadPart + 9999) / 10000;
+        else                                                        // absolute FILETIME, UTC
+        {
+            qwNow = __w4uGetSystemFileTime();
+
+            if ((uint64_t)lpDueTime->QuadPart > qwNow)
+                qwDelay = ((uint64_t)lpDueTime->QuadPart - qwNow + 9999) / 10000;
+        }
+
+        __w4uWheelCancel(&pTimer->Node);
+
+        pTimer->fSignaled = 0;
+        pTimer->Period = (uint32_t)lPeriod;
+
+        __w4uWheelArm(&pTimer->Node, __w4uClockTickCount() + 1 + qwDelay);   // current millisecond partly gone, never early
+
+        if (fResume)
+            _w4udwLastError = ERROR_NOT_SUPPORTED;
+
+        fRet = 1;
+
+    } while (0);
+
+    return fRet;
+}
+
+/** CancelWaitableTimer()
+Synopsis
+    BOOL CancelWaitableTimer([in] HANDLE hTimer);
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-cancelwaitabletimer#syntax
+Description
+    Sets the specified waitable timer to the inactive state. The signaled state is not changed.
+Paramters
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-cancelwaitabletimer#parameters
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-cancelwaitabletimer#return-value
+**/
+BOOL WINAPI _w4uCancelWaitableTimer(_In_ HANDLE hTimer)
+{
+    W4UTIMER* pTimer = hTimer;
+
+    if (NULL == pTimer || INVALID_HANDLE_VALUE == pTimer || W4UTIMER_ID != pTimer->signature)
+    {
+        _w4udwLastError = ERROR_INVALID_HANDLE;
+        return 0;
+    }
+
+    __w4uWheelCancel(&pTimer->Node);
+
+    return 1;
+}
+
+void* __imp_SetWaitableTimer = (void*)_w4uSetWaitableTimer;
+void* __imp_CancelWaitableTimer = (void*)_w4uCancelWaitableTimer;
@@ -10,19 +10,48 @@ Module Name:
 
 Abstract:
 
-    Win32 API GetTickCount64() for UEFI
+    Win32 API Sleep() for UEFI
 
-    Retrieves the number of milliseconds that have elapsed since the system was started.
+    Waits on a one-shot UEFI timer event, so the CPU halts in the DXE core idle loop and
+    notify functions keep running. The timer event resolution is the timer interrupt period, see timeBeginPeriod(),
+    the remainder below one period is a spin on the clock source counter, see W4UGetClockSource().
+
+    W4UStall() is the microsecond spin for driver style code.
 
 Author:
 
     Kilian Kegel
 
 --*/
+#include <uefi.h>
+#include <stdlib.h>
 #include <stdint.h>
-#include <time.h>
+#include <intrin.h>
 #include "LibWin324UEFI.h"
 
+extern EFI_SYSTEM_TABLE* _cdegST;
+
+#define SLEEP_INFINITE  0xFFFFFFFF              // INFINITE
+#define SLEEP_SLICE     10000000                // 1s in 100ns units, the clock source is read at least once per slice
+
+static EFI_EVENT _w4uSleepEvent;
+
+/** __w4uSleepEventAtExit()
+Synopsis
+    static void __w4uSleepEventAtExit(void);
+Description
+    Close the timer event
+Paramters
+    none
+Returns
+    none
+**/
+static void __w4uSleepEventAtExit(void)
+{
+    _cdegST->BootServices->CloseEvent(_w4uSleepEvent);
+    _w4uSleepEvent = NULL;
+}
+
 /** Sleep()
 Synopsis
     void Sleep(uint32_t dwMilliseconds);
@@ -30,6 +59,9 @@ Synopsis
 Description
     Suspends the execution of the current thread until the time-out interval elapses.
 
+    NOTE:   Sleep(0) lets notify functions of signaled events run and returns.
+            Above TPL_APPLICATION, e.g. in a notify function, WaitForEvent() is not allowed, Sleep() spins.
+
 Paramters
     https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-sleep#parameters
 Returns
@@ -37,9 +69,74 @@ Returns
 **/
 void Sleep4UEFI(uint32_t dwMilliseconds)
 {
-    clock_t end = (clock_t)dwMilliseconds + clock();
-    while (end > clock())
-        ;
+    EFI_BOOT_SERVICES* pBS = _cdegST->BootServices;
+    uint64_t qwFreq, qwEnd, qwNow, qwLeft, qwPeriod;
+    EFI_TPL Tpl;
+    UINTN Index;
+
+    Tpl = pBS->RaiseTPL(TPL_HIGH_LEVEL);
+    pBS->RestoreTPL(Tpl);                               // dispatch pending notify functions
+
+    while (SLEEP_INFINITE == dwMilliseconds)
+        Sleep4UEFI(SLEEP_INFINITE - 1);
+
+    if (0 == dwMilliseconds)
+        return;
+
+    qwFreq = __w4uClockFrequency();
+    qwEnd = __w4uClockRead() + dwMilliseconds / 1000 * qwFreq + dwMilliseconds % 1000 * qwFreq / 1000;
+
+    if (TPL_APPLICATION == Tpl && NULL == _w4uSleepEvent)
+    {
+        if (EFI_SUCCESS == pBS->CreateEvent(EVT_TIMER, 0, NULL, NULL, &_w4uSleepEvent))
+            atexit(__w4uSleepEventAtExit);
+        else
+            _w4uSleepEvent = NULL;
+    }
+
+    if (TPL_APPLICATION == Tpl && NULL != _w4uSleepEvent)
+    {
+        qwPeriod = __w4uTimerPeriod();
+
+        while (qwEnd > (qwNow = __w4uClockRead()))
+        {
+            qwLeft = (qwEnd - qwNow) / qwFreq * 10000000 + (qwEnd - qwNow) % qwFreq * 10000000 / qwFreq;
+
+            if (qwLeft <= qwPeriod)
+                break;                                  // spin the remainder
+
+            qwLeft -= qwPeriod;                         // the event is signaled on the first timer interrupt after the due time
+
+            if (EFI_SUCCESS != pBS->SetTimer(_w4uSleepEvent, TimerRelative, qwLeft < SLEEP_SLICE ? qwLeft : SLEEP_SLICE))
+                break;
+
+            pBS->WaitForEvent(1, &_w4uSleepEvent, &Index);
+        }
+    }
+
+    while (qwEnd > __w4uClockRead())
+        _mm_pause();
+}
+
+/** W4UStall()
+Synopsis
+    void W4UStall(uint64_t qwMicroseconds);
+Description
+    Spin on the clock source counter, see W4UGetClockSource(), e.g. for hardware timing.
+    Unlike Sleep(), W4UStall() doesn't wait on timer events, the CPU keeps running and
+    no notify function runs, unless the timer interrupt dispatches one.
+Paramters
+    uint64_t qwMicroseconds : microseconds
+Returns
+    none
+**/
+void W4UStall(uint64_t qwMicroseconds)
+{
+    uint64_t qwFreq = __w4uClockFrequency();
+    uint64_t qwEnd = __w4uClockRead() + qwMicroseconds / 1000000 * qwFreq + qwMicroseconds % 1000000 * qwFreq / 1000000;
+
+    while (qwEnd > __w4uClockRead())
+        _mm_pause();
 }
 
 void WINAPI _w4uSleep(/*_In_*/ DWORD dwMilliseconds)
@@ -47,4 +144,4 @@ void WINAPI _w4uSleep(/*_In_*/ DWORD dwMilliseconds)
     Sleep4UEFI(dwMilliseconds);
 }
 
-void* __imp_Sleep = (void*)_w4uSleep;
\ No newline at end of file
+void* __imp_Sleep = (void*)_w4uSleep;
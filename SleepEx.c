@@ -0,0 +1,52 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    SleepEx.c
+
+Abstract:
+
+    Win32 API SleepEx() for UEFI
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdint.h>
+#include "LibWin324UEFI.h"
+
+extern void Sleep4UEFI(uint32_t dwMilliseconds);
+
+/** SleepEx()
+Synopsis
+    DWORD SleepEx(DWORD dwMilliseconds, BOOL bAlertable);
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-sleepex#syntax
+Description
+    Suspends the current thread until the specified condition is met.
+
+    NOTE:   UEFI has no asynchronous procedure calls or I/O completion routines,
+            bAlertable has no effect, SleepEx() always waits until the time-out interval elapses, see Sleep().
+
+Paramters
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-sleepex#parameters
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-sleepex#return-value
+**/
+uint32_t SleepEx4UEFI(uint32_t dwMilliseconds, int bAlertable)
+{
+    Sleep4UEFI(dwMilliseconds);
+
+    return 0;
+}
+
+DWORD WINAPI _w4uSleepEx(/*_In_*/ DWORD dwMilliseconds, /*_In_*/ BOOL bAlertable)
+{
+    return SleepEx4UEFI(dwMilliseconds, bAlertable);
+}
+
+void* __imp_SleepEx = (void*)_w4uSleepEx;
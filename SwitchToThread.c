@@ -0,0 +1,52 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    SwitchToThread.c
+
+Abstract:
+
+    Win32 API SwitchToThread() for UEFI
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdint.h>
+#include "LibWin324UEFI.h"
+
+extern void Sleep4UEFI(uint32_t dwMilliseconds);
+
+/** SwitchToThread()
+Synopsis
+    BOOL SwitchToThread();
+    https://docs.microsoft.com/en-us/windows/win32/api/processthreadsapi/nf-processthreadsapi-switchtothread#syntax
+Description
+    Causes the calling thread to yield execution to another thread that is ready to run on the current processor.
+
+    NOTE:   UEFI has a single thread, notify functions of signaled events run instead, see Sleep(0)
+
+Paramters
+    
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/processthreadsapi/nf-processthreadsapi-switchtothread#return-value
+    always 0, no other thread
+**/
+int SwitchToThread4UEFI(void)
+{
+    Sleep4UEFI(0);
+
+    return 0;
+}
+
+BOOL WINAPI _w4uSwitchToThread(void)
+{
+    return SwitchToThread4UEFI();
+}
+
+void* __imp_SwitchToThread = (void*)_w4uSwitchToThread;
@@ -0,0 +1,106 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    W4UAcpiIter.c
+
+Abstract:
+
+    Iterator over all instances of an ACPI table signature, e.g. all SSDTs
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <Protocol\AcpiSystemDescriptionTable.h>
+#include "LibWin324UEFI.h"
+
+/** W4UAcpiTableCount()
+Synopsis
+    uint32_t W4UAcpiTableCount(uint32_t Signature);
+Description
+    Get the number of ACPI tables with a given signature
+Paramters
+    uint32_t Signature  : table signature, e.g. 'TDSS', 0 for all tables
+Returns
+    number of tables
+**/
+uint32_t W4UAcpiTableCount(uint32_t Signature)
+{
+    if (0 == Signature)
+        return __w4uGetAcpiIndex()->nTables;
+
+    return __w4uAcpiCountTables(Signature);
+}
+
+/** W4UAcpiIterInit()
+Synopsis
+    void W4UAcpiIterInit(W4UACPIITER* pIter, uint32_t Signature);
+Description
+    Initialize an iterator over all ACPI tables with a given signature
+
+        W4UACPIITER Iter;
+
+        W4UAcpiIterInit(&Iter, 'TDSS');
+        while (W4UAcpiIterNext(&Iter, &pTbl, &sizeTbl))
+            ...
+Paramters
+    W4UACPIITER* pIter  : iterator
+    uint32_t Signature  : table signature, e.g. 'TDSS', 0 for all tables incl. XSDT, DSDT and FACS
+Returns
+    none
+**/
+void W4UAcpiIterInit(W4UACPIITER* pIter, uint32_t Signature)
+{
+    pIter->Signature = Signature;
+    pIter->Instance = 0;
+}
+
+/** W4UAcpiIterNext()
+Synopsis
+    BOOL W4UAcpiIterNext(W4UACPIITER* pIter, const void** ppTable, uint32_t* pSize);
+Description
+    Get the next ACPI table, in XSDT order. The table is not copied and must not be modified.
+    In validation mode, see W4USetAcpiValidation(), invalid tables are skipped.
+Paramters
+    W4UACPIITER* pIter  : iterator
+    const void** ppTable: table address
+    uint32_t* pSize     : optional, table size in bytes
+Returns
+    1   :   *ppTable is valid, pIter->Instance - 1 is its instance number
+    0   :   no more tables
+**/
+BOOL W4UAcpiIterNext(W4UACPIITER* pIter, const void** ppTable, uint32_t* pSize)
+{
+    W4UACPIINDEX* pIndex = __w4uGetAcpiIndex();
+    void* pTbl = NULL;
+
+    do {
+        if (0 == pIter->Signature)
+            pTbl = pIter->Instance < pIndex->nTables ? pIndex->pTable[pIter->Instance] : NULL;
+        else
+            pTbl = __w4uAcpiFindTable(pIter->Signature, pIter->Instance);
+
+        if (NULL == pTbl)
+            return 0;
+
+        pIter->Instance++;
+
+    } while (_w4uAcpiValidation && W4U_ACPI_VALID != W4UValidateAcpiTable(pTbl));  // validation mode: skip invalid tables
+    *ppTable = pTbl;
+
+    if (NULL != pSize)
+        *pSize = ((EFI_ACPI_2_0_COMMON_HEADER*)pTbl)->Length;
+
+    return 1;
+}
@@ -0,0 +1,138 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    W4UAml.c
+
+Abstract:
+
+    Lookup of AML named objects in DSDT and SSDTs by namespace path, e.g. "\_SB.PCI0._PRT"
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include "LibWin324UEFI.h"
+
+/** W4UAmlFindName()
+Synopsis
+    const W4UAMLNAME* W4UAmlFindName(const char* pszPath);
+Description
+    Find a named object by its absolute namespace path. NameSegs are separated by '.',
+    short NameSegs are padded with '_', lower case is converted to upper case:
+
+        "\\_SB.PCI0._PRT", "\\_SB_.PCI0._PRT", "\\"
+
+    The AML index is built on first use and rebuilt after a change of the ACPI tables,
+    each lookup is one hash probe per NameSeg.
+Paramters
+    const char* pszPath : absolute path, starting with '\'
+Returns
+    pointer to the index entry, NULL if not found or pszPath is malformed
+**/
+const W4UAMLNAME* W4UAmlFindName(const char* pszPath)
+{
+    W4UAMLINDEX* pIndex = __w4uGetAmlIndex();
+    uint32_t Node = 0, NameSeg, slot, i;
+    char Seg[4];
+
+    if (NULL == pszPath || '\\' != *pszPath++ || NULL == pIndex->pHash)
+        return NULL;
+
+    while ('\0' != *pszPath)
+    {
+        for (i = 0; i < 4 && '\0' != *pszPath && '.' != *pszPath; i++)
+            Seg[i] = (char)toupper((unsigned char)*pszPath++);
+
+        if (0 == i || ('\0' != *pszPath && '.' != *pszPath))
+            return NULL;                                            // empty or too long NameSeg
+
+        for (; i < 4; i++)
+            Seg[i] = '_';
+
+        if ('.' == *pszPath && '\0' == *++pszPath)
+            return NULL;                                            // trailing '.'
+
+        memcpy(&NameSeg, Seg, sizeof(NameSeg));
+        slot = __w4uAmlHashSlot(pIndex, Node, NameSeg);
+
+        if (0 == pIndex->pHash[slot])
+            return NULL;
+
+        Node = pIndex->pHash[slot] - 1;
+    }
+
+    return &pIndex->pName[Node];
+}
+
+/** W4UAmlGetName()
+Synopsis
+    const W4UAMLNAME* W4UAmlGetName(uint32_t Index);
+Description
+    Enumerate the AML index, in order of declaration. Index 0 is the root scope.
+Paramters
+    uint32_t Index  : 0, 1, 2...
+Returns
+    pointer to the index entry, NULL if Index is out of range
+**/
+const W4UAMLNAME* W4UAmlGetName(uint32_t Index)
+{
+    W4UAMLINDEX* pIndex = __w4uGetAmlIndex();
+
+    return Index < pIndex->nNames ? &pIndex->pName[Index] : NULL;
+}
+
+/** W4UAmlGetPath()
+Synopsis
+    uint32_t W4UAmlGetPath(const W4UAMLNAME* pName, char* pszBuffer, uint32_t BufferSize);
+Description
+    Get the absolute namespace path of an index entry, e.g. "\_SB_.PCI0._PRT"
+Paramters
+    const W4UAMLNAME* pName : index entry, returned by W4UAmlFindName() or W4UAmlGetName()
+    char* pszBuffer         : buffer or NULL
+    uint32_t BufferSize     : buffer size
+Returns
+    required buffer size incl. terminating '\0', the path is copied only if it fits into BufferSize
+    0 if pName is not an index entry
+**/
+uint32_t W4UAmlGetPath(const W4UAMLNAME* pName, char* pszBuffer, uint32_t BufferSize)
+{
+    W4UAMLINDEX* pIndex = __w4uGetAmlIndex();
+    uint32_t Node, nSegs = 0, size, pos;
+
+    if (NULL == pName || pName < pIndex->pName || pName >= pIndex->pName + pIndex->nNames)
+        return 0;
+
+    Node = (uint32_t)(pName - pIndex->pName);
+
+    for (; 0 != Node; Node = pIndex->pName[Node].Parent)
+        nSegs++;
+
+    size = 0 == nSegs ? 2 : 5 * nSegs + 1;                          // "\" + "XXXX." per NameSeg, last '.' is '\0'
+
+    if (NULL == pszBuffer || BufferSize < size)
+        return size;
+
+    pszBuffer[0] = '\\';
+    pszBuffer[size - 1] = '\0';
+
+    for (pos = size - 5, Node = (uint32_t)(pName - pIndex->pName); 0 != Node; Node = pIndex->pName[Node].Parent, pos -= 5)
+    {
+        memcpy(&pszBuffer[pos], &pIndex->pName[Node].NameSeg, 4);
+
+        if (pos > 1)
+            pszBuffer[pos - 1] = '.';
+    }
+
+    return size;
+}
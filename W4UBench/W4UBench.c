@@ -0,0 +1,241 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    W4UBench.c
+
+Abstract:
+
+    Benchmark tool for the Win32 API for UEFI
+
+    UEFI Shell application, linked to LibWin324UEFI.lib and the Toro C Library.
+    The benchmarks use the Win32 API only, except "checksum" that uses the W4UValidateAcpiTable() extension,
+    "scale" the firmware capture and table view extensions and "qpc" W4USetQpcSerialization().
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "W4UBench.h"
+
+int64_t _qwQPF;
+int _fCsv;
+
+static const struct {
+    const char* pszName;
+    int (*pfnBench)(int argc, char** argv);
+    const char* pszHelp;
+}BenchTbl[] = {
+    {"file",    BenchFile,      "file [-b<size>|-a] [-d<sec>] [-w<pct>] [-r] [-c<size>] <file>"},
+    {"replay",  BenchReplay,    "replay <tracefile> [<directory>]"},
+    {"acpi",    BenchAcpi,      "acpi [-n<count>]"},
+    {"checksum",BenchChecksum,  "checksum [-s<size>] [-n<count>]"},
+    {"scale",   BenchScale,     "scale [-t<tables>] [-s<size>] [-n<count>]"},
+    {"qpc",     BenchQpc,       "qpc [-n<count>]"},
+};
+
+/** BenchQPC()
+Synopsis
+    int64_t BenchQPC(void);
+Description
+    QueryPerformanceCounter() shortcut
+Returns
+    performance counter
+**/
+int64_t BenchQPC(void)
+{
+    LARGE_INTEGER li;
+
+    QueryPerformanceCounter(&li);
+
+    return li.QuadPart;
+}
+
+/** BenchTicksToUs()
+Synopsis
+    double BenchTicksToUs(uint64_t qwTicks);
+Description
+    Convert performance counter ticks to microseconds
+Returns
+    microseconds
+**/
+double BenchTicksToUs(uint64_t qwTicks)
+{
+    return 1000000.0 * (double)qwTicks / (double)_qwQPF;
+}
+
+/** BenchHistoInit()
+Synopsis
+    void BenchHistoInit(W4UBENCHHISTO* pHisto);
+Description
+    Clear latency histogram
+**/
+void BenchHistoInit(W4UBENCHHISTO* pHisto)
+{
+    memset(pHisto, 0, sizeof(W4UBENCHHISTO));
+    pHisto->qwTicksMin = (uint64_t)-1;
+}
+
+/** BenchHistoIndex()
+Synopsis
+    static unsigned BenchHistoIndex(uint64_t qwTicks);
+Description
+    Get histogram bucket: values below W4UBENCH_HISTO_SUB are linear,
+    above W4UBENCH_HISTO_SUB sub-buckets per power of two
+**/
+static unsigned BenchHistoIndex(uint64_t qwTicks)
+{
+    unsigned msb = 0;
+
+    if (qwTicks < W4UBENCH_HISTO_SUB)
+        return (unsigned)qwTicks;
+
+    while ((qwTicks >> msb) >= 2 * W4UBENCH_HISTO_SUB)
+        msb++;
+
+    return (msb + 1) * W4UBENCH_HISTO_SUB + (unsigned)((qwTicks >> msb) - W4UBENCH_HISTO_SUB);
+}
+
+/** BenchHistoUpper()
+Synopsis
+    static uint64_t BenchHistoUpper(unsigned idx);
+Description
+    Get the upper limit of a histogram bucket, inverse of BenchHistoIndex()
+**/
+static uint64_t BenchHistoUpper(unsigned idx)
+{
+    unsigned msb;
+
+    if (idx < W4UBENCH_HISTO_SUB)
+        return idx;
+
+    msb = idx / W4UBENCH_HISTO_SUB - 1;
+
+    return (((uint64_t)(idx % W4UBENCH_HISTO_SUB + W4UBENCH_HISTO_SUB) + 1) << msb) - 1;
+}
+
+/** BenchHistoAdd()
+Synopsis
+    void BenchHistoAdd(W4UBENCHHISTO* pHisto, uint64_t qwTicks);
+Description
+    Add one latency sample to the histogram
+**/
+void BenchHistoAdd(W4UBENCHHISTO* pHisto, uint64_t qwTicks)
+{
+    unsigned idx = BenchHistoIndex(qwTicks);
+
+    pHisto->Count[idx < W4UBENCH_HISTO_MAX ? idx : W4UBENCH_HISTO_MAX - 1]++;
+    pHisto->nSamples++;
+    pHisto->qwTicksTotal += qwTicks;
+
+    if (qwTicks < pHisto->qwTicksMin)
+        pHisto->qwTicksMin = qwTicks;
+    if (qwTicks > pHisto->qwTicksMax)
+        pHisto->qwTicksMax = qwTicks;
+}
+
+/** BenchHistoPercentileUs()
+Synopsis
+    double BenchHistoPercentileUs(W4UBENCHHISTO* pHisto, double Percentile);
+Description
+    Get the latency percentile, e.g. Percentile == 99.9 for p999
+Returns
+    latency in microseconds, upper limit of the histogram bucket
+**/
+double BenchHistoPercentileUs(W4UBENCHHISTO* pHisto, double Percentile)
+{
+    uint64_t nLimit = (uint64_t)((double)pHisto->nSamples * Percentile / 100.0);
+    uint64_t nSum = 0;
+    unsigned idx;
+
+    for (idx = 0; idx < W4UBENCH_HISTO_MAX; idx++)
+    {
+        nSum += pHisto->Count[idx];
+        if (nSum > nLimit)
+            break;
+    }
+
+    if (idx >= W4UBENCH_HISTO_MAX)
+        return BenchTicksToUs(pHisto->qwTicksMax);
+
+    return BenchTicksToUs(BenchHistoUpper(idx) < pHisto->qwTicksMax ? BenchHistoUpper(idx) : pHisto->qwTicksMax);
+}
+
+/** BenchParseSize()
+Synopsis
+    uint64_t BenchParseSize(const char* pszSize);
+Description
+    Parse a size with optional K, M, G suffix, e.g. "512", "4K", "16M"
+Returns
+    size in bytes
+**/
+uint64_t BenchParseSize(const char* pszSize)
+{
+    char* pEnd;
+    uint64_t qwSize = strtoull(pszSize, &pEnd, 0);
+
+    switch (*pEnd)
+    {
+        case 'k': case 'K': qwSize <<= 10; break;
+        case 'm': case 'M': qwSize <<= 20; break;
+        case 'g': case 'G': qwSize <<= 30; break;
+    }
+
+    return qwSize;
+}
+
+/** BenchRand64()
+Synopsis
+    uint64_t BenchRand64(void);
+Description
+    xorshift64* pseudo random number generator, fixed seed for reproducible patterns
+**/
+uint64_t BenchRand64(void)
+{
+    static uint64_t x = 0x9E3779B97F4A7C15ULL;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+int main(int argc, char** argv)
+{
+    LARGE_INTEGER li;
+    int i, nRet = 1;
+
+    QueryPerformanceFrequency(&li);
+    _qwQPF = li.QuadPart;
+
+    if (argc > 1 && 0 == strcmp("-csv", argv[1]))
+    {
+        _fCsv = 1;
+        argc--;
+        argv++;
+    }
+
+    for (i = 0; argc > 1 && i < sizeof(BenchTbl) / sizeof(BenchTbl[0]); i++)
+    {
+        if (0 == strcmp(BenchTbl[i].pszName, argv[1]))
+            return BenchTbl[i].pfnBench(argc - 1, &argv[1]);
+    }
+
+    printf("usage: W4UBench [-csv] <benchmark> [options]\n");
+
+    for (i = 0; i < sizeof(BenchTbl) / sizeof(BenchTbl[0]); i++)
+        printf("    W4UBench %s\n", BenchTbl[i].pszHelp);
+
+    return nRet;
+}
@@ -0,0 +1,67 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    W4UBench.h
+
+Abstract:
+
+    Benchmark tool for the Win32 API for UEFI common definitions
+
+Author:
+
+    Kilian Kegel
+
+--*/
+
+#ifndef _W4UBENCH_H_
+#define _W4UBENCH_H_
+
+//
+// latency histogram, 16 linear sub-buckets per power of two of QueryPerformanceCounter() ticks
+//
+#define W4UBENCH_HISTO_SUB  16
+#define W4UBENCH_HISTO_MAX  (64 * W4UBENCH_HISTO_SUB)
+
+typedef struct tagW4UBENCHHISTO
+{
+    uint64_t    nSamples;
+    uint64_t    qwTicksTotal;
+    uint64_t    qwTicksMin;
+    uint64_t    qwTicksMax;
+    uint64_t    Count[W4UBENCH_HISTO_MAX];
+
+}W4UBENCHHISTO;
+
+//
+// globals
+//
+extern int64_t _qwQPF;                          // QueryPerformanceFrequency(), counts per second
+extern int _fCsv;                               // machine readable output
+
+//
+// common functions
+//
+extern int64_t BenchQPC(void);
+extern double BenchTicksToUs(uint64_t qwTicks);
+extern void BenchHistoInit(W4UBENCHHISTO* pHisto);
+extern void BenchHistoAdd(W4UBENCHHISTO* pHisto, uint64_t qwTicks);
+extern double BenchHistoPercentileUs(W4UBENCHHISTO* pHisto, double Percentile);
+extern uint64_t BenchParseSize(const char* pszSize);
+extern uint64_t BenchRand64(void);
+
+//
+// benchmarks
+//
+extern int BenchFile(int argc, char** argv);
+extern int BenchReplay(int argc, char** argv);
+extern int BenchAcpi(int argc, char** argv);
+extern int BenchChecksum(int argc, char** argv);
+extern int BenchScale(int argc, char** argv);
+extern int BenchQpc(int argc, char** argv);
+
+#endif//_W4UBENCH_H_
@@ -0,0 +1,262 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    W4UBenchAcpi.c
+
+Abstract:
+
+    Firmware table benchmarks for GetSystemFirmwareTable() and EnumSystemFirmwareTables()
+
+        acpi    : table lookups with the Windows two-call pattern, size query and copy
+        checksum: W4UValidateAcpiTable() on a synthetic DSDT, compared to a scalar byte loop
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "LibWin324UEFI.h"
+#include "W4UBench.h"
+
+/** BenchAcpi()
+Synopsis
+    int BenchAcpi(int argc, char** argv);
+Description
+    W4UBench acpi [-n<count>]
+
+        -n<count>   number of lookups, default 10000
+
+    The first EnumSystemFirmwareTables() call is timed separately, since it includes one time
+    initialization. Subsequent lookups cycle through all signatures reported by EnumSystemFirmwareTables(),
+    each with a size query GetSystemFirmwareTable(..., NULL, 0) and a copy to the buffer.
+**/
+int BenchAcpi(int argc, char** argv)
+{
+    static W4UBENCHHISTO HistoSize, HistoCopy;
+    uint32_t nLookups = 10000, nSigs, i;
+    DWORD* pSigs = NULL;
+    uint8_t* pBuf = NULL;
+    UINT sizeEnum, sizeTbl, sizeBuf = 0;
+    int64_t qwStart, qwEnd, qwFirst;
+    int nRet = 1;
+
+    for (i = 1; i < (uint32_t)argc; i++)
+    {
+        if ('-' == argv[i][0] && 'n' == argv[i][1])
+            nLookups = (uint32_t)strtoul(&argv[i][2], NULL, 0);
+    }
+
+    do {
+        qwStart = BenchQPC();
+        sizeEnum = EnumSystemFirmwareTables('ACPI', NULL, 0);
+        qwFirst = BenchQPC() - qwStart;
+
+        nSigs = sizeEnum / sizeof(DWORD);
+
+        if (0 == nSigs || NULL == (pSigs = malloc(sizeEnum)))
+        {
+            printf("no ACPI tables\n");
+            break;
+        }
+
+        EnumSystemFirmwareTables('ACPI', pSigs, sizeEnum);
+
+        BenchHistoInit(&HistoSize);
+        BenchHistoInit(&HistoCopy);
+
+        for (i = 0; i < nLookups; i++)
+        {
+            DWORD Sig = pSigs[i % nSigs];
+
+            qwStart = BenchQPC();
+            sizeTbl = GetSystemFirmwareTable('ACPI', Sig, NULL, 0);
+            qwEnd = BenchQPC();
+
+            BenchHistoAdd(&HistoSize, (uint64_t)(qwEnd - qwStart));
+
+            if (sizeTbl > sizeBuf)
+            {
+                free(pBuf);
+                sizeBuf = sizeTbl;
+                if (NULL == (pBuf = malloc(sizeBuf)))
+                    break;
+            }
+
+            qwStart = BenchQPC();
+            GetSystemFirmwareTable('ACPI', Sig, pBuf, sizeBuf);
+            qwEnd = BenchQPC();
+
+            BenchHistoAdd(&HistoCopy, (uint64_t)(qwEnd - qwStart));
+        }
+
+        if (i != nLookups)
+        {
+            printf("out of memory\n");
+            break;
+        }
+
+        if (!_fCsv)
+        {
+            printf("first EnumSystemFirmwareTables(): %.2f us, %u tables\n", BenchTicksToUs((uint64_t)qwFirst), nSigs);
+            printf("%-10s %10s %10s %10s %10s\n", "call", "lookups", "avg[us]", "p50[us]", "p99[us]");
+        }
+
+        printf(_fCsv ? "acpi,%s,%u,%.3f,%.3f,%.3f\n" : "%-10s %10u %10.3f %10.3f %10.3f\n",
+            "size", nLookups,
+            BenchTicksToUs(HistoSize.qwTicksTotal) / nLookups,
+            BenchHistoPercentileUs(&HistoSize, 50.0),
+            BenchHistoPercentileUs(&HistoSize, 99.0));
+
+        printf(_fCsv ? "acpi,%s,%u,%.3f,%.3f,%.3f\n" : "%-10s %10u %10.3f %10.3f %10.3f\n",
+            "copy", nLookups,
+            BenchTicksToUs(HistoCopy.qwTicksTotal) / nLookups,
+            BenchHistoPercentileUs(&HistoCopy, 50.0),
+            BenchHistoPercentileUs(&HistoCopy, 99.0));
+
+        nRet = 0;
+
+    } while (0);
+
+    free(pBuf);
+    free(pSigs);
+
+    return nRet;
+}
+
+/** BenchChecksum()
+Synopsis
+    int BenchChecksum(int argc, char** argv);
+Description
+    W4UBench checksum [-s<size>] [-n<count>]
+
+        -s<size>    size of the synthetic DSDT, default 1M
+        -n<count>   number of checksum runs, default 100
+
+    Compare the ACPI checksum of a scalar byte loop with W4UValidateAcpiTable().
+    The synthetic table is not in the ACPI table index, so W4UValidateAcpiTable() computes
+    the checksum on each call. Additionally the cached validation of the system DSDT is timed.
+**/
+int BenchChecksum(int argc, char** argv)
+{
+    static W4UBENCHHISTO HistoScalar, HistoVector, HistoCached;
+    uint32_t sizeTbl = 1024 * 1024, nRuns = 100, i, j, sizeDsdt;
+    volatile uint8_t Sum = 0;
+    const void* pDsdt = NULL;
+    int64_t qwStart, qwEnd;
+    uint8_t* pTbl;
+    int nRet = 1;
+
+    for (i = 1; i < (uint32_t)argc; i++)
+    {
+        if ('-' == argv[i][0] && 's' == argv[i][1])
+            sizeTbl = (uint32_t)BenchParseSize(&argv[i][2]);
+        if ('-' == argv[i][0] && 'n' == argv[i][1])
+            nRuns = (uint32_t)strtoul(&argv[i][2], NULL, 0);
+    }
+
+    if (sizeTbl < 36 || sizeTbl > W4U_ACPI_TABLE_MAX_LENGTH || NULL == (pTbl = malloc(sizeTbl)))
+    {
+        printf("usage: W4UBench checksum [-s<size>] [-n<count>], size 36 ... 16M\n");
+        return 1;
+    }
+
+    //
+    // synthetic DSDT: header, random AML body, valid checksum
+    //
+    for (j = 0; j < sizeTbl; j++)
+        pTbl[j] = (uint8_t)BenchRand64();
+
+    memcpy(&pTbl[0], "DSDT", 4);
+    memcpy(&pTbl[4], &sizeTbl, 4);
+    pTbl[9] = 0;
+
+    for (Sum = 0, j = 0; j < sizeTbl; j++)
+        Sum += pTbl[j];
+
+    pTbl[9] = (uint8_t)(0 - Sum);
+
+    BenchHistoInit(&HistoScalar);
+    BenchHistoInit(&HistoVector);
+    BenchHistoInit(&HistoCached);
+
+    do {
+        for (i = 0; i < nRuns; i++)
+        {
+            uint8_t s = 0;
+
+            qwStart = BenchQPC();
+            for (j = 0; j < sizeTbl; j++)
+                s += pTbl[j];
+            Sum = s;
+            qwEnd = BenchQPC();
+            BenchHistoAdd(&HistoScalar, (uint64_t)(qwEnd - qwStart));
+
+            qwStart = BenchQPC();
+            Sum = (uint8_t)W4UValidateAcpiTable(pTbl);
+            qwEnd = BenchQPC();
+            BenchHistoAdd(&HistoVector, (uint64_t)(qwEnd - qwStart));
+
+            if (W4U_ACPI_VALID != Sum)
+                break;
+        }
+
+        if (i != nRuns)
+        {
+            printf("W4UValidateAcpiTable() failed\n");
+            break;
+        }
+
+        //
+        // system DSDT: the first call validates, subsequent calls return the cached result
+        //
+        if (W4UGetFirmwareTableView('ACPI', 'TDSD', 0, &pDsdt, &sizeDsdt))
+        {
+            for (i = 0; i < nRuns; i++)
+            {
+                qwStart = BenchQPC();
+                Sum = (uint8_t)W4UValidateAcpiTable(pDsdt);
+                qwEnd = BenchQPC();
+                BenchHistoAdd(&HistoCached, (uint64_t)(qwEnd - qwStart));
+            }
+        }
+
+        if (!_fCsv)
+            printf("%-10s %10s %10s %10s %10s %10s\n", "checksum", "size", "runs", "avg[us]", "p50[us]", "MB/s");
+
+        printf(_fCsv ? "checksum,%s,%u,%u,%.3f,%.3f,%.1f\n" : "%-10s %10u %10u %10.3f %10.3f %10.1f\n",
+            "scalar", sizeTbl, nRuns,
+            BenchTicksToUs(HistoScalar.qwTicksTotal) / nRuns,
+            BenchHistoPercentileUs(&HistoScalar, 50.0),
+            (double)sizeTbl * nRuns / BenchTicksToUs(HistoScalar.qwTicksTotal));
+
+        printf(_fCsv ? "checksum,%s,%u,%u,%.3f,%.3f,%.1f\n" : "%-10s %10u %10u %10.3f %10.3f %10.1f\n",
+            "vector", sizeTbl, nRuns,
+            BenchTicksToUs(HistoVector.qwTicksTotal) / nRuns,
+            BenchHistoPercentileUs(&HistoVector, 50.0),
+            (double)sizeTbl * nRuns / BenchTicksToUs(HistoVector.qwTicksTotal));
+
+        if (0 != HistoCached.nSamples)
+            printf(_fCsv ? "checksum,%s,%u,%u,%.3f,%.3f,\n" : "%-10s %10u %10u %10.3f %10.3f %10s\n",
+                "cached", sizeDsdt, nRuns,
+                BenchTicksToUs(HistoCached.qwTicksTotal) / nRuns,
+                BenchHistoPercentileUs(&HistoCached, 50.0),
+                "-");
+
+        nRet = 0;
+
+    } while (0);
+
+    free(pTbl);
+
+    return nRet;
+}
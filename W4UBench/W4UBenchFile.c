@@ -0,0 +1,419 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    W4UBenchFile.c
+
+Abstract:
+
+    File I/O benchmarks for CreateFile(), ReadFile(), WriteFile() and SetFilePointer()
+
+        file    : sequential/random read/write patterns, diskspd-like
+        replay  : replay a W4UTraceStart() file I/O trace
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "LibWin324UEFI.h"
+#include "W4UBench.h"
+
+#define BENCHFILE_BLOCK_MIN     512
+#define BENCHFILE_BLOCK_MAX     (16 * 1024 * 1024)
+
+/** BenchFileSeek()
+Synopsis
+    static BOOL BenchFileSeek(HANDLE hFile, uint64_t qwOffset);
+Description
+    Set the 64 bit file pointer
+**/
+static BOOL BenchFileSeek(HANDLE hFile, uint64_t qwOffset)
+{
+    LONG lHigh = (LONG)(qwOffset >> 32);
+
+    return INVALID_SET_FILE_POINTER != SetFilePointer(hFile, (LONG)qwOffset, &lHigh, FILE_BEGIN);
+}
+
+/** BenchFilePrepare()
+Synopsis
+    static HANDLE BenchFilePrepare(const char* pszFile, uint64_t qwFileSize);
+Description
+    Open the test file, create and fill it, if it doesn't exist or is too small
+**/
+static HANDLE BenchFilePrepare(const char* pszFile, uint64_t qwFileSize)
+{
+    HANDLE hFile = CreateFileA(pszFile, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LONG lHigh = 0;
+    uint64_t qwSize = 0, qwDone;
+    DWORD dwLow, dwWritten;
+    uint8_t* pBuf;
+
+    if (INVALID_HANDLE_VALUE != hFile)
+    {
+        dwLow = SetFilePointer(hFile, 0, &lHigh, FILE_END);
+        qwSize = (uint64_t)(uint32_t)lHigh << 32 | dwLow;
+
+        if (qwSize >= qwFileSize)
+            return hFile;
+
+        CloseHandle(hFile);
+    }
+
+    hFile = CreateFileA(pszFile, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    pBuf = malloc(1024 * 1024);
+
+    if (INVALID_HANDLE_VALUE == hFile || NULL == pBuf)
+    {
+        free(pBuf);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    for (qwDone = 0; qwDone < qwFileSize; qwDone += dwWritten)
+    {
+        DWORD dwChunk = (DWORD)(qwFileSize - qwDone < 1024 * 1024 ? qwFileSize - qwDone : 1024 * 1024);
+
+        memset(pBuf, (int)(qwDone >> 20), dwChunk);
+
+        if (!WriteFile(hFile, pBuf, dwChunk, &dwWritten, NULL) || 0 == dwWritten)
+        {
+            CloseHandle(hFile);
+            hFile = INVALID_HANDLE_VALUE;
+            break;
+        }
+    }
+
+    free(pBuf);
+
+    return hFile;
+}
+
+/** BenchFileRun()
+Synopsis
+    static int BenchFileRun(HANDLE hFile, uint64_t qwFileSize, DWORD dwBlock, unsigned Seconds, unsigned WritePct, int fRandom);
+Description
+    Run one pattern for the given duration and print MB/s, IOPS and latency percentiles
+**/
+static int BenchFileRun(HANDLE hFile, uint64_t qwFileSize, DWORD dwBlock, unsigned Seconds, unsigned WritePct, int fRandom)
+{
+    static W4UBENCHHISTO Histo;
+    uint64_t nBlocks = qwFileSize / dwBlock, qwOffset = 0, qwBytes = 0;
+    int64_t qwStart, qwEnd, qwOpStart, qwOpEnd, qwDeadline;
+    uint8_t* pBuf = malloc(dwBlock);
+    DWORD dwDone;
+    BOOL fOk;
+    double Secs;
+
+    if (NULL == pBuf || 0 == nBlocks)
+    {
+        free(pBuf);
+        printf("block size %lu: file too small or out of memory\n", (unsigned long)dwBlock);
+        return 1;
+    }
+
+    memset(pBuf, 0x5A, dwBlock);
+    BenchHistoInit(&Histo);
+
+    qwStart = BenchQPC();
+    qwDeadline = qwStart + (int64_t)Seconds * _qwQPF;
+    qwEnd = qwStart;
+
+    while (qwEnd < qwDeadline)
+    {
+        if (fRandom)
+            qwOffset = (BenchRand64() % nBlocks) * dwBlock;
+        else if (qwOffset + dwBlock > qwFileSize)
+            qwOffset = 0;
+
+        qwOpStart = BenchQPC();
+
+        fOk = BenchFileSeek(hFile, qwOffset);
+
+        if (fOk)
+        {
+            if (BenchRand64() % 100 < WritePct)
+                fOk = WriteFile(hFile, pBuf, dwBlock, &dwDone, NULL);
+            else
+                fOk = ReadFile(hFile, pBuf, dwBlock, &dwDone, NULL);
+        }
+
+        qwOpEnd = BenchQPC();
+
+        if (!fOk || dwDone != dwBlock)
+        {
+            printf("I/O error at offset %llu, GetLastError() %lu\n", (unsigned long long)qwOffset, (unsigned long)GetLastError());
+            free(pBuf);
+            return 1;
+        }
+
+        BenchHistoAdd(&Histo, (uint64_t)(qwOpEnd - qwOpStart));
+        qwBytes += dwBlock;
+        qwOffset += dwBlock;
+        qwEnd = qwOpEnd;
+    }
+
+    free(pBuf);
+
+    Secs = (double)(qwEnd - qwStart) / (double)_qwQPF;
+
+    printf(_fCsv ? "file,%s,%lu,%u,%.2f,%.0f,%.2f,%.2f,%.2f\n" : "%-10s %9lu %5u%% %10.2f %10.0f %10.2f %10.2f %10.2f\n",
+        fRandom ? "random" : "sequential",
+        (unsigned long)dwBlock,
+        WritePct,
+        (double)qwBytes / (1024.0 * 1024.0) / Secs,
+        (double)Histo.nSamples / Secs,
+        BenchHistoPercentileUs(&Histo, 50.0),
+        BenchHistoPercentileUs(&Histo, 99.0),
+        BenchHistoPercentileUs(&Histo, 99.9)
+    );
+
+    return 0;
+}
+
+/** BenchFile()
+Synopsis
+    int BenchFile(int argc, char** argv);
+Description
+    W4UBench file [-b<size>|-a] [-d<sec>] [-w<pct>] [-r] [-c<size>] <file>
+
+        -b<size>    block size 512 ... 16M, default 64K
+        -a          all block sizes 512 ... 16M, powers of two
+        -d<sec>     duration per block size in seconds, default 10
+        -w<pct>     percentage of writes, default 0 (read only)
+        -r          random offsets, block size aligned, default sequential
+        -c<size>    file size, default 64M, the file is created if it doesn't exist or is too small
+**/
+int BenchFile(int argc, char** argv)
+{
+    uint64_t qwBlock = 64 * 1024, qwFileSize = 64 * 1024 * 1024;
+    unsigned Seconds = 10, WritePct = 0;
+    int fRandom = 0, fAll = 0, i, nRet = 0;
+    const char* pszFile = NULL;
+    HANDLE hFile;
+
+    for (i = 1; i < argc; i++)
+    {
+        if ('-' != argv[i][0])
+            pszFile = argv[i];
+        else switch (argv[i][1])
+        {
+            case 'b': qwBlock = BenchParseSize(&argv[i][2]); break;
+            case 'a': fAll = 1; break;
+            case 'd': Seconds = (unsigned)strtoul(&argv[i][2], NULL, 10); break;
+            case 'w': WritePct = (unsigned)strtoul(&argv[i][2], NULL, 10); break;
+            case 'r': fRandom = 1; break;
+            case 'c': qwFileSize = BenchParseSize(&argv[i][2]); break;
+            default: pszFile = NULL; i = argc; break;
+        }
+    }
+
+    if (NULL == pszFile || qwBlock < BENCHFILE_BLOCK_MIN || qwBlock > BENCHFILE_BLOCK_MAX || WritePct > 100)
+    {
+        printf("usage: W4UBench file [-b<size>|-a] [-d<sec>] [-w<pct>] [-r] [-c<size>] <file>\n");
+        return 1;
+    }
+
+    hFile = BenchFilePrepare(pszFile, qwFileSize);
+
+    if (INVALID_HANDLE_VALUE == hFile)
+    {
+        printf("can't create %s, GetLastError() %lu\n", pszFile, (unsigned long)GetLastError());
+        return 1;
+    }
+
+    if (!_fCsv)
+        printf("%-10s %9s %6s %10s %10s %10s %10s %10s\n", "pattern", "block", "write", "MB/s", "IOPS", "p50[us]", "p99[us]", "p999[us]");
+
+    if (fAll)
+    {
+        for (qwBlock = BENCHFILE_BLOCK_MIN; 0 == nRet && qwBlock <= BENCHFILE_BLOCK_MAX; qwBlock *= 2)
+            nRet = BenchFileRun(hFile, qwFileSize, (DWORD)qwBlock, Seconds, WritePct, fRandom);
+    }
+    else
+        nRet = BenchFileRun(hFile, qwFileSize, (DWORD)qwBlock, Seconds, WritePct, fRandom);
+
+    CloseHandle(hFile);
+
+    return nRet;
+}
+
+/** BenchReplay()
+Synopsis
+    int BenchReplay(int argc, char** argv);
+Description
+    W4UBench replay <tracefile> [<directory>]
+
+    Replay a file I/O trace recorded by W4UTraceStart() as fast as possible and
+    compare the time spent per operation with the recorded time.
+    <directory> replaces the directory of each recorded file name,
+    to run the trace against local stand-in files.
+**/
+int BenchReplay(int argc, char** argv)
+{
+    static const char* OpName[] = { "?", "create", "read", "write", "seek", "close" };
+    static W4UBENCHHISTO Histo[6];
+    static HANDLE hMap[W4U_HANDLEV_MAX];
+    double RecUs[6] = { 0 };
+    W4UTRACEHDR Hdr;
+    W4UTRACEREC* pRecs = NULL;
+    uint8_t* pBuf = NULL;
+    uint32_t i, dwBufSize = 0;
+    size_t nRead;
+    FILE* fp;
+    int nRet = 1;
+
+    if (argc < 2 || NULL == (fp = fopen(argv[1], "rb")))
+    {
+        printf("usage: W4UBench replay <tracefile> [<directory>]\n");
+        return 1;
+    }
+
+    for (i = 0; i < W4U_HANDLEV_MAX; i++)
+        hMap[i] = INVALID_HANDLE_VALUE;
+
+    do {
+        nRead = fread(&Hdr, sizeof(Hdr), 1, fp);
+
+        if (1 != nRead || W4UTRACE_SIGNATURE != Hdr.Signature || sizeof(W4UTRACEREC) != Hdr.RecSize)
+        {
+            printf("%s is not a trace file\n", argv[1]);
+            break;
+        }
+
+        pRecs = malloc((size_t)Hdr.NumRecs * sizeof(W4UTRACEREC));
+
+        if (NULL == pRecs || Hdr.NumRecs != fread(pRecs, sizeof(W4UTRACEREC), Hdr.NumRecs, fp))
+        {
+            printf("can't read %s\n", argv[1]);
+            break;
+        }
+
+        for (i = 0; i < 6; i++)
+            BenchHistoInit(&Histo[i]);
+
+        for (i = 0; i < Hdr.NumRecs; i++)
+        {
+            W4UTRACEREC* pRec = &pRecs[i];
+            HANDLE hFile = pRec->Handle < W4U_HANDLEV_MAX ? hMap[pRec->Handle] : INVALID_HANDLE_VALUE;
+            int64_t qwStart, qwEnd;
+            DWORD dwDone;
+
+            if (pRec->Op < W4UTRACE_CREATE || pRec->Op > W4UTRACE_CLOSE)
+                continue;
+
+            if (W4UTRACE_READ == pRec->Op || W4UTRACE_WRITE == pRec->Op)
+            {
+                if (pRec->Size > dwBufSize)
+                {
+                    free(pBuf);
+                    dwBufSize = pRec->Size;
+                    pBuf = calloc(1, dwBufSize);
+                    if (NULL == pBuf)
+                    {
+                        printf("out of memory\n");
+                        break;
+                    }
+                }
+            }
+
+            if (W4UTRACE_CREATE == pRec->Op)
+            {
+                const char* pszName = (const char*)&pRec[1];
+                char szPath[W4U_MAX_PATH];
+
+                if (argc > 2)
+                {
+                    const char* pBase = strrchr(pszName, '\\');
+                    snprintf(szPath, sizeof(szPath), "%s\\%s", argv[2], NULL == pBase ? pszName : pBase + 1);
+                    pszName = szPath;
+                }
+
+                qwStart = BenchQPC();
+                hFile = CreateFileA(pszName, (DWORD)(pRec->Offset >> 32), 0, NULL, (DWORD)pRec->Offset, FILE_ATTRIBUTE_NORMAL, NULL);
+                qwEnd = BenchQPC();
+
+                if (pRec->Handle < W4U_HANDLEV_MAX)
+                    hMap[pRec->Handle] = hFile;
+
+                i += (pRec->Size + sizeof(W4UTRACEREC)) / sizeof(W4UTRACEREC);  // skip path name
+            }
+            else
+            {
+                if (INVALID_HANDLE_VALUE == hFile)
+                    continue;                           // file not available, CreateFile() failed
+
+                qwStart = BenchQPC();
+
+                switch (pRec->Op)
+                {
+                    case W4UTRACE_READ:
+                        ReadFile(hFile, pBuf, pRec->Size, &dwDone, NULL);
+                        break;
+                    case W4UTRACE_WRITE:
+                        WriteFile(hFile, pBuf, pRec->Size, &dwDone, NULL);
+                        break;
+                    case W4UTRACE_SEEK:
+                    {
+                        LONG lHigh = (LONG)(pRec->Offset >> 32);
+                        SetFilePointer(hFile, (LONG)pRec->Offset, &lHigh, pRec->Size);
+                        break;
+                    }
+                    case W4UTRACE_CLOSE:
+                        CloseHandle(hFile);
+                        hMap[pRec->Handle] = INVALID_HANDLE_VALUE;
+                        break;
+                }
+
+                qwEnd = BenchQPC();
+            }
+
+            BenchHistoAdd(&Histo[pRec->Op], (uint64_t)(qwEnd - qwStart));
+
+            if (0 != Hdr.TscPerSec)
+                RecUs[pRec->Op] += 1000000.0 * (double)(pRec->TscEnd - pRec->TscStart) / (double)Hdr.TscPerSec;
+        }
+
+        if (NULL == pBuf && 0 != dwBufSize)
+            break;                                      // out of memory, replay incomplete
+
+        if (!_fCsv)
+            printf("%-8s %10s %14s %14s %10s %10s\n", "op", "count", "recorded[us]", "replayed[us]", "p50[us]", "p99[us]");
+
+        for (i = W4UTRACE_CREATE; i <= W4UTRACE_CLOSE; i++)
+        {
+            printf(_fCsv ? "replay,%s,%llu,%.2f,%.2f,%.2f,%.2f\n" : "%-8s %10llu %14.2f %14.2f %10.2f %10.2f\n",
+                OpName[i],
+                (unsigned long long)Histo[i].nSamples,
+                RecUs[i],
+                BenchTicksToUs(Histo[i].qwTicksTotal),
+                BenchHistoPercentileUs(&Histo[i], 50.0),
+                BenchHistoPercentileUs(&Histo[i], 99.0)
+            );
+        }
+
+        if (0 != Hdr.NumLost)
+            printf("NOTE: %lu calls were not recorded due to trace buffer overflow\n", (unsigned long)Hdr.NumLost);
+
+        nRet = 0;
+
+    } while (0);
+
+    for (i = 0; i < W4U_HANDLEV_MAX; i++)
+        if (INVALID_HANDLE_VALUE != hMap[i])
+            CloseHandle(hMap[i]);
+
+    free(pBuf);
+    free(pRecs);
+    fclose(fp);
+
+    return nRet;
+}
@@ -0,0 +1,433 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    W4UBenchScale.c
+
+Abstract:
+
+    Scaling benchmark for the firmware table APIs on synthetic ACPI/SMBIOS trees
+
+    FADT, FACS, DSDT, APIC, HPET, MCFG, SSDTs and an SMBIOS structure table are built in memory
+    and installed by W4UFirmwareCaptureInstall(), that synthesizes RSDP, XSDT and SMBIOS 3.x entry point.
+    The platform's firmware tables are restored by W4UFirmwareCaptureReset() afterwards.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "LibWin324UEFI.h"
+#include "W4UBench.h"
+
+#define SCALE_FIXED_TABLES  6                   // FACP, FACS, DSDT, APIC, HPET, MCFG
+#define SCALE_SSDT_SIZE     1024
+#define SCALE_SMBIOS_TYPE17 32                  // memory devices in the synthetic SMBIOS table
+
+static const uint32_t ScaleTables[] = { 10, 100, 500, 1000, 5000 };
+static const uint32_t ScaleDsdtSizes[] = { 64 * 1024, 1024 * 1024, 16 * 1024 * 1024 };
+
+/** BenchScaleTable()
+Synopsis
+    static void BenchScaleTable(uint8_t* pTbl, const char* pszSig, uint32_t Length, uint32_t Instance);
+Description
+    Initialize an ACPI table header and set the checksum, the table body is left as is
+**/
+static void BenchScaleTable(uint8_t* pTbl, const char* pszSig, uint32_t Length, uint32_t Instance)
+{
+    uint8_t Sum = 0;
+    uint32_t i;
+
+    memcpy(&pTbl[0], pszSig, 4);
+    memcpy(&pTbl[4], &Length, 4);
+    pTbl[8] = 2;                                                    // Revision
+    pTbl[9] = 0;
+    memcpy(&pTbl[10], "W4UBEN", 6);                                 // OemId
+    snprintf((char*)&pTbl[16], 9, "SC%06X", Instance & 0xFFFFFF);   // OemTableId, differs per SSDT
+
+    for (i = 0; i < Length; i++)
+        Sum += pTbl[i];
+
+    pTbl[9] = (uint8_t)(0 - Sum);
+}
+
+/** BenchScaleInstall()
+Synopsis
+    static BOOL BenchScaleInstall(uint32_t nTables, uint32_t sizeDsdt);
+Description
+    Build and install a synthetic firmware table tree:
+    nTables ACPI tables incl. FACS and DSDT, the remainder above SCALE_FIXED_TABLES are SSDTs,
+    the DSDT body is random data, the SMBIOS table holds type 0, 1, SCALE_SMBIOS_TYPE17 type 17 and type 127
+**/
+static BOOL BenchScaleInstall(uint32_t nTables, uint32_t sizeDsdt)
+{
+    static const char* FixedSigs[] = { "APIC", "HPET", "MCFG" };
+    uint32_t sizeBuf = sizeDsdt > SCALE_SSDT_SIZE ? sizeDsdt : SCALE_SSDT_SIZE, i;
+    uint8_t* pBuf = calloc(1, sizeBuf);
+    uint8_t* pSmbios = NULL, * p;
+    BOOL nRet = 0;
+
+    do {
+        if (NULL == pBuf)
+            break;
+
+        //
+        // FADT ACPI 6.x, DSDT/FACS pointers are set by W4UFirmwareCaptureInstall()
+        //
+        BenchScaleTable(pBuf, "FACP", 276, 0);
+        if (!W4UFirmwareCaptureAddTable(pBuf))
+            break;
+
+        memset(pBuf, 0, 64);                                        // FACS has no checksum
+        memcpy(pBuf, "FACS", 4);
+        pBuf[4] = 64;
+        if (!W4UFirmwareCaptureAddTable(pBuf))
+            break;
+
+        for (i = 36; i < sizeDsdt; i++)
+            pBuf[i] = (uint8_t)BenchRand64();
+        BenchScaleTable(pBuf, "DSDT", sizeDsdt, 0);
+        if (!W4UFirmwareCaptureAddTable(pBuf))
+            break;
+
+        memset(pBuf, 0, SCALE_SSDT_SIZE);
+
+        for (i = 0; i < sizeof(FixedSigs) / sizeof(FixedSigs[0]); i++)
+        {
+            BenchScaleTable(pBuf, FixedSigs[i], 64, 0);
+            if (!W4UFirmwareCaptureAddTable(pBuf))
+                break;
+        }
+
+        if (i < sizeof(FixedSigs) / sizeof(FixedSigs[0]))
+            break;
+
+        for (i = SCALE_FIXED_TABLES; i < nTables; i++)
+        {
+            BenchScaleTable(pBuf, "SSDT", SCALE_SSDT_SIZE, i);
+            if (!W4UFirmwareCaptureAddTable(pBuf))
+                break;
+        }
+
+        if (i < nTables)
+            break;
+
+        //
+        // SMBIOS: formatted area and one string per structure, double NUL terminated
+        //
+        if (NULL == (p = pSmbios = calloc(SCALE_SMBIOS_TYPE17 + 3, 64)))
+            break;
+
+        for (i = 0; i < SCALE_SMBIOS_TYPE17 + 3; i++)
+        {
+            uint8_t Type = 0 == i ? 0 : 1 == i ? 1 : i < SCALE_SMBIOS_TYPE17 + 2 ? 17 : 127;
+
+            p[0] = Type;
+            p[1] = 127 == Type ? 4 : 0x28;
+            p[2] = (uint8_t)i;
+            p += p[1];
+
+            if (127 != Type)
+                p += 1 + sprintf((char*)p, "W4UBench %u", i);
+            else
+                *p++ = '\0';
+
+            *p++ = '\0';
+        }
+
+        if (!W4UFirmwareCaptureAddSmbios(pSmbios, (uint32_t)(p - pSmbios)))
+            break;
+
+        nRet = W4UFirmwareCaptureInstall();
+
+    } while (0);
+
+    free(pSmbios);
+    free(pBuf);
+
+    return nRet;
+}
+
+/** BenchScalePrint()
+Synopsis
+    static void BenchScalePrint(const char* pszOp, uint32_t nTables, uint32_t sizeDsdt, W4UBENCHHISTO* pHisto);
+Description
+    Print one result line
+**/
+static void BenchScalePrint(const char* pszOp, uint32_t nTables, uint32_t sizeDsdt, W4UBENCHHISTO* pHisto)
+{
+    if (0 == pHisto->nSamples)
+        return;
+
+    printf(_fCsv ? "scale,%s,%u,%u,%llu,%.3f,%.3f,%.3f\n" : "%-10s %8u %10u %8llu %10.3f %10.3f %10.3f\n",
+        pszOp, nTables, sizeDsdt, (unsigned long long)pHisto->nSamples,
+        BenchTicksToUs(pHisto->qwTicksTotal) / (double)pHisto->nSamples,
+        BenchHistoPercentileUs(pHisto, 50.0),
+        BenchHistoPercentileUs(pHisto, 99.0));
+}
+
+/** BenchScaleDump()
+Synopsis
+    static uint32_t BenchScaleDump(const uint32_t* pSigs, uint32_t nSigs, uint8_t* pBuf, uint32_t sizeBuf);
+Description
+    Get all ACPI tables the way a Win32 dump tool does: each signature listed by EnumSystemFirmwareTables(),
+    SSDTs by instance, then DSDT and FACS, each by a size query followed by the copy
+**/
+static uint32_t BenchScaleDump(const uint32_t* pSigs, uint32_t nSigs, uint8_t* pBuf, uint32_t sizeBuf)
+{
+    uint32_t i, nSsdt = 0, size, nTotal = 0;
+
+    for (i = 0; i < nSigs + 2; i++)
+    {
+        uint32_t Sig = i < nSigs ? pSigs[i] : i == nSigs ? 'TDSD' : 'SCAF';
+        int Instance = 'TDSS' == Sig ? (int)nSsdt++ : 0;
+
+        size = GetSystemFirmwareTable4UEFI('ACPI', Sig, NULL, 0, NULL, Instance);
+
+        if (size <= sizeBuf)
+            nTotal += GetSystemFirmwareTable4UEFI('ACPI', Sig, pBuf, size, NULL, Instance);
+    }
+
+    return nTotal;
+}
+
+/** BenchScaleRun()
+Synopsis
+    static int BenchScaleRun(uint32_t nTables, uint32_t sizeDsdt, uint32_t nRuns);
+Description
+    Install one synthetic tree and time the Win32 paths existing tools use:
+        build   : first EnumSystemFirmwareTables4UEFI() size query, includes building the ACPI table index
+        enum    : EnumSystemFirmwareTables4UEFI() with buffer
+        lookupsz: GetSystemFirmwareTable4UEFI() size query, cycling through FACP, APIC, HPET, MCFG, DSDT
+        lookup  : GetSystemFirmwareTable4UEFI() size query followed by the copy, same tables
+        nth     : GetSystemFirmwareTable4UEFI() copy of a random SSDT instance
+        ssdtloop: GetSystemFirmwareTable4UEFI() copy of SSDT instance 0, 1, ... until not found, one sample per loop
+        dump    : all tables from EnumSystemFirmwareTables4UEFI() and GetSystemFirmwareTable4UEFI(), see BenchScaleDump(),
+                  nRuns / 100 times, at least once
+        smbios  : GetSystemFirmwareTable4UEFI('RSMB', ...) size query
+    and for comparison the extension APIs:
+        nth-view : W4UGetFirmwareTableView() of a random SSDT instance
+        loop-iter: W4UAcpiIterInit()/W4UAcpiIterNext() over all SSDTs
+        dump-snap: W4UGetFirmwareSnapshot() of all tables
+**/
+static int BenchScaleRun(uint32_t nTables, uint32_t sizeDsdt, uint32_t nRuns)
+{
+    static const uint32_t LookupSigs[] = { 'PCAF', 'CIPA', 'TEPH', 'GFCM', 'TDSD' };
+    static W4UBENCHHISTO Histo;
+    uint32_t sizeBuf = sizeDsdt > SCALE_SSDT_SIZE ? sizeDsdt : SCALE_SSDT_SIZE;
+    uint32_t nSsdt, i, j, sizeEnum, size, nDump = nRuns / 100 ? nRuns / 100 : 1;
+    W4UACPIITER Iter;
+    const void* pTbl;
+    uint32_t* pSigs = NULL;
+    uint8_t* pBuf = NULL;
+    void* pSnapshot;
+    int64_t qwStart;
+    int nRet = 1;
+
+    do {
+        if (!BenchScaleInstall(nTables, sizeDsdt))
+        {
+            printf("out of memory, %u tables, DSDT %u\n", nTables, sizeDsdt);
+            break;
+        }
+
+        BenchHistoInit(&Histo);
+        qwStart = BenchQPC();
+        sizeEnum = EnumSystemFirmwareTables4UEFI('ACPI', NULL, 0);
+        BenchHistoAdd(&Histo, (uint64_t)(BenchQPC() - qwStart));
+
+        nSsdt = W4UAcpiTableCount('TDSS');
+
+        if (sizeEnum / sizeof(uint32_t) != nTables - 2 || nSsdt != nTables - SCALE_FIXED_TABLES)   // DSDT and FACS are not listed
+        {
+            printf("incomplete ACPI table index, %u of %u tables listed\n", sizeEnum / (uint32_t)sizeof(uint32_t), nTables - 2);
+            break;
+        }
+
+        BenchScalePrint("build", nTables, sizeDsdt, &Histo);
+
+        if (NULL == (pSigs = malloc(sizeEnum + sizeof(uint32_t))) || NULL == (pBuf = malloc(sizeBuf)))
+        {
+            printf("out of memory\n");
+            break;
+        }
+
+        BenchHistoInit(&Histo);
+        for (i = 0; i < nRuns; i++)
+        {
+            qwStart = BenchQPC();
+            EnumSystemFirmwareTables4UEFI('ACPI', pSigs, sizeEnum);
+            BenchHistoAdd(&Histo, (uint64_t)(BenchQPC() - qwStart));
+        }
+        BenchScalePrint("enum", nTables, sizeDsdt, &Histo);
+
+        BenchHistoInit(&Histo);
+        for (i = 0; i < nRuns; i++)
+        {
+            qwStart = BenchQPC();
+            GetSystemFirmwareTable4UEFI('ACPI', LookupSigs[i % (sizeof(LookupSigs) / sizeof(LookupSigs[0]))], NULL, 0, NULL, 0);
+            BenchHistoAdd(&Histo, (uint64_t)(BenchQPC() - qwStart));
+        }
+        BenchScalePrint("lookupsz", nTables, sizeDsdt, &Histo);
+
+        BenchHistoInit(&Histo);
+        for (i = 0; i < nRuns; i++)
+        {
+            uint32_t Sig = LookupSigs[i % (sizeof(LookupSigs) / sizeof(LookupSigs[0]))];
+
+            qwStart = BenchQPC();
+            size = GetSystemFirmwareTable4UEFI('ACPI', Sig, NULL, 0, NULL, 0);
+            if (size <= sizeBuf)
+                GetSystemFirmwareTable4UEFI('ACPI', Sig, pBuf, size, NULL, 0);
+            BenchHistoAdd(&Histo, (uint64_t)(BenchQPC() - qwStart));
+        }
+        BenchScalePrint("lookup", nTables, sizeDsdt, &Histo);
+
+        BenchHistoInit(&Histo);
+        for (i = 0; i < nRuns && 0 != nSsdt; i++)
+        {
+            int Instance = (int)(BenchRand64() % nSsdt);
+
+            qwStart = BenchQPC();
+            GetSystemFirmwareTable4UEFI('ACPI', 'TDSS', pBuf, sizeBuf, NULL, Instance);
+            BenchHistoAdd(&Histo, (uint64_t)(BenchQPC() - qwStart));
+        }
+        BenchScalePrint("nth", nTables, sizeDsdt, &Histo);
+
+        BenchHistoInit(&Histo);
+        for (i = 0; i < nRuns && 0 != nSsdt; i++)
+        {
+            qwStart = BenchQPC();
+            for (j = 0; 0 != GetSystemFirmwareTable4UEFI('ACPI', 'TDSS', pBuf, sizeBuf, NULL, (int)j); j++)
+                ;
+            BenchHistoAdd(&Histo, (uint64_t)(BenchQPC() - qwStart));
+        }
+        BenchScalePrint("ssdtloop", nTables, sizeDsdt, &Histo);
+
+        BenchHistoInit(&Histo);
+        for (i = 0; i < nDump; i++)
+        {
+            qwStart = BenchQPC();
+            EnumSystemFirmwareTables4UEFI('ACPI', pSigs, EnumSystemFirmwareTables4UEFI('ACPI', NULL, 0));
+            BenchScaleDump(pSigs, sizeEnum / sizeof(uint32_t), pBuf, sizeBuf);
+            BenchHistoAdd(&Histo, (uint64_t)(BenchQPC() - qwStart));
+        }
+        BenchScalePrint("dump", nTables, sizeDsdt, &Histo);
+
+        BenchHistoInit(&Histo);
+        for (i = 0; i < nRuns; i++)
+        {
+            qwStart = BenchQPC();
+            GetSystemFirmwareTable4UEFI('RSMB', 0, NULL, 0);
+            BenchHistoAdd(&Histo, (uint64_t)(BenchQPC() - qwStart));
+        }
+        BenchScalePrint("smbios", nTables, sizeDsdt, &Histo);
+
+        //
+        // extension APIs, for comparison
+        //
+        BenchHistoInit(&Histo);
+        for (i = 0; i < nRuns && 0 != nSsdt; i++)
+        {
+            uint32_t Instance = (uint32_t)(BenchRand64() % nSsdt);
+
+            qwStart = BenchQPC();
+            W4UGetFirmwareTableView('ACPI', 'TDSS', Instance, &pTbl, NULL);
+            BenchHistoAdd(&Histo, (uint64_t)(BenchQPC() - qwStart));
+        }
+        BenchScalePrint("nth-view", nTables, sizeDsdt, &Histo);
+
+        BenchHistoInit(&Histo);
+        for (i = 0; i < nRuns && 0 != nSsdt; i++)
+        {
+            qwStart = BenchQPC();
+            W4UAcpiIterInit(&Iter, 'TDSS');
+            while (W4UAcpiIterNext(&Iter, &pTbl, NULL))
+                ;
+            BenchHistoAdd(&Histo, (uint64_t)(BenchQPC() - qwStart));
+        }
+        BenchScalePrint("loop-iter", nTables, sizeDsdt, &Histo);
+
+        BenchHistoInit(&Histo);
+        for (i = 0; i < nDump; i++)
+        {
+            qwStart = BenchQPC();
+            W4UGetFirmwareSnapshot(NULL, 0, &pSnapshot);
+            free(pSnapshot);
+            BenchHistoAdd(&Histo, (uint64_t)(BenchQPC() - qwStart));
+        }
+        BenchScalePrint("dump-snap", nTables, sizeDsdt, &Histo);
+
+        nRet = 0;
+
+    } while (0);
+
+    free(pBuf);
+    free(pSigs);
+    W4UFirmwareCaptureReset();
+
+    return nRet;
+}
+
+/** BenchScale()
+Synopsis
+    int BenchScale(int argc, char** argv);
+Description
+    W4UBench scale [-t<tables>] [-s<size>] [-n<count>]
+
+        -t<tables>  number of ACPI tables incl. FACS and DSDT, default 10, 100, 500, 1000 and 5000
+        -s<size>    DSDT size, default 64K, 1M and 16M
+        -n<count>   number of calls per operation, default 1000
+
+    Each combination of table count and DSDT size is installed and measured, see BenchScaleRun().
+    A run fails, if EnumSystemFirmwareTables() does not list all tables of the tree.
+**/
+int BenchScale(int argc, char** argv)
+{
+    uint32_t nTables = 0, sizeDsdt = 0, nRuns = 1000, i, t, s;
+    int nRet = 0;
+
+    for (i = 1; i < (uint32_t)argc; i++)
+    {
+        if ('-' == argv[i][0] && 't' == argv[i][1])
+            nTables = (uint32_t)strtoul(&argv[i][2], NULL, 0);
+        if ('-' == argv[i][0] && 's' == argv[i][1])
+            sizeDsdt = (uint32_t)BenchParseSize(&argv[i][2]);
+        if ('-' == argv[i][0] && 'n' == argv[i][1])
+            nRuns = (uint32_t)strtoul(&argv[i][2], NULL, 0);
+    }
+
+    if ((0 != nTables && nTables < SCALE_FIXED_TABLES) || (0 != sizeDsdt && (sizeDsdt < 36 || sizeDsdt > W4U_ACPI_TABLE_MAX_LENGTH)) || 0 == nRuns)
+    {
+        printf("usage: W4UBench scale [-t<tables>] [-s<size>] [-n<count>], tables 6 ... , size 36 ... 16M\n");
+        return 1;
+    }
+
+    if (!_fCsv)
+        printf("%-10s %8s %10s %8s %10s %10s %10s\n", "scale", "tables", "dsdt", "calls", "avg[us]", "p50[us]", "p99[us]");
+
+    for (t = 0; t < sizeof(ScaleTables) / sizeof(ScaleTables[0]); t++)
+    {
+        if (0 != nTables && 0 != t)
+            break;
+
+        for (s = 0; s < sizeof(ScaleDsdtSizes) / sizeof(ScaleDsdtSizes[0]); s++)
+        {
+            if (0 != sizeDsdt && 0 != s)
+                break;
+
+            nRet |= BenchScaleRun(0 != nTables ? nTables : ScaleTables[t], 0 != sizeDsdt ? sizeDsdt : ScaleDsdtSizes[s], nRuns);
+        }
+    }
+
+    return nRet;
+}
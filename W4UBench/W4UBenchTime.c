@@ -0,0 +1,117 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    W4UBenchTime.c
+
+Abstract:
+
+    Time API benchmarks
+
+        qpc : per call overhead of QueryPerformanceCounter() and QueryPerformanceFrequency()
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "LibWin324UEFI.h"
+#include "W4UBench.h"
+
+/** BenchQpcLoop()
+Synopsis
+    static void BenchQpcLoop(const char* pszMode, uint32_t nCalls);
+Description
+    Time nCalls back-to-back QueryPerformanceCounter() calls and print the per call overhead
+    and the smallest non-zero difference of two consecutive counter values
+**/
+static void BenchQpcLoop(const char* pszMode, uint32_t nCalls)
+{
+    LARGE_INTEGER li, liPrev;
+    uint64_t qwMinDelta = (uint64_t)-1;
+    int64_t qwStart, qwEnd;
+    uint32_t i;
+
+    QueryPerformanceCounter(&liPrev);
+    qwStart = BenchQPC();
+
+    for (i = 0; i < nCalls; i++)
+    {
+        QueryPerformanceCounter(&li);
+
+        if (li.QuadPart != liPrev.QuadPart && (uint64_t)(li.QuadPart - liPrev.QuadPart) < qwMinDelta)
+            qwMinDelta = (uint64_t)(li.QuadPart - liPrev.QuadPart);
+
+        liPrev = li;
+    }
+
+    qwEnd = BenchQPC();
+
+    printf(_fCsv ? "qpc,%s,%u,%.2f,%llu\n" : "%-10s %10u %10.2f %10llu\n",
+        pszMode, nCalls,
+        1000.0 * BenchTicksToUs((uint64_t)(qwEnd - qwStart)) / nCalls,
+        (unsigned long long)((uint64_t)-1 == qwMinDelta ? 0 : qwMinDelta));
+}
+
+/** BenchQpc()
+Synopsis
+    int BenchQpc(int argc, char** argv);
+Description
+    W4UBench qpc [-n<count>]
+
+        -n<count>   number of calls, default 1000000
+
+    Per call overhead of QueryPerformanceCounter(), plain and in serialized mode, see W4USetQpcSerialization(),
+    and of QueryPerformanceFrequency(). "delta" is the smallest counter difference of two consecutive calls.
+**/
+int BenchQpc(int argc, char** argv)
+{
+    uint32_t nCalls = 1000000, i;
+    LARGE_INTEGER li;
+    int64_t qwStart, qwEnd;
+
+    for (i = 1; i < (uint32_t)argc; i++)
+    {
+        if ('-' == argv[i][0] && 'n' == argv[i][1])
+            nCalls = (uint32_t)strtoul(&argv[i][2], NULL, 0);
+    }
+
+    if (0 == nCalls)
+    {
+        printf("usage: W4UBench qpc [-n<count>]\n");
+        return 1;
+    }
+
+    if (!_fCsv)
+    {
+        printf("QueryPerformanceFrequency(): %lld\n", (long long)_qwQPF);
+        printf("%-10s %10s %10s %10s\n", "qpc", "calls", "ns/call", "delta");
+    }
+
+    BenchQpcLoop("plain", nCalls);
+
+    W4USetQpcSerialization(1);
+    BenchQpcLoop("serialized", nCalls);
+    W4USetQpcSerialization(0);
+
+    qwStart = BenchQPC();
+    for (i = 0; i < nCalls; i++)
+        QueryPerformanceFrequency(&li);
+    qwEnd = BenchQPC();
+
+    printf(_fCsv ? "qpc,%s,%u,%.2f,\n" : "%-10s %10u %10.2f %10s\n",
+        "qpf", nCalls,
+        1000.0 * BenchTicksToUs((uint64_t)(qwEnd - qwStart)) / nCalls,
+        "-");
+
+    return 0;
+}
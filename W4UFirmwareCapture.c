@@ -0,0 +1,546 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    W4UFirmwareCapture.c
+
+Abstract:
+
+    Firmware table capture loader, replays captured ACPI tables and SMBIOS data through
+    GetSystemFirmwareTable(), EnumSystemFirmwareTables() and the W4U firmware table extensions
+
+    Supported capture files:
+        acpidump text output            : all tables of a platform, "XXXX @ 0x..." followed by hex dump lines
+        raw binary ACPI tables          : acpixtract *.dat files, one or more concatenated tables
+        SMBIOS entry point              : e.g. /sys/firmware/dmi/tables/smbios_entry_point, version only
+        SMBIOS structure table          : e.g. /sys/firmware/dmi/tables/DMI
+
+    W4UFirmwareCaptureInstall() builds a synthetic RSDP, XSDT and SMBIOS 3.x entry point in memory
+    and installs them by W4USetFirmwareTableProvider().
+    Captures taken on many platforms, e.g. by acpidump on Linux, can so be replayed in the UEFI Shell.
+
+    NOTE: the loader is part of the UEFI library, it depends on <uefi.h>, the EDK2 GUID definitions and
+          _cdegST of the Toro C Library. There is no host build, the firmware table functions and their
+          benchmarks do not run on a Linux or Windows host.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <ctype.h>
+#include <Guid\Acpi.h>
+#include <Protocol\AcpiSystemDescriptionTable.h>
+#include <Guid\SmBios.h>
+#include <IndustryStandard\SmBios.h>
+#include "LibWin324UEFI.h"
+
+static void** _w4uCapTable;                         // captured ACPI tables, RSDP, RSDT and XSDT excluded
+static uint32_t _w4uCapTables;
+static uint32_t _w4uCapTablesMax;                   // size of _w4uCapTable[], doubled on demand
+static uint8_t* _w4uCapSmbios;                      // captured SMBIOS structure table
+static uint32_t _w4uCapSmbiosSize;
+static uint8_t _w4uCapSmbiosVersion[3] = { 3, 0, 0 };   // major, minor, docrev
+
+static EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER _w4uCapRsdp;
+static EFI_ACPI_DESCRIPTION_HEADER* _w4uCapXsdt;
+static SMBIOS_TABLE_3_0_ENTRY_POINT _w4uCapSmbios3;
+static EFI_CONFIGURATION_TABLE _w4uCapConfigTable[2];
+
+/** __w4uCapIsSignature()
+Synopsis
+    static int __w4uCapIsSignature(const uint8_t* p);
+Description
+    Check for a plausible ACPI table signature, 4 alphanumeric characters or '_'
+Paramters
+    const uint8_t* p    : signature
+Returns
+    1   :   plausible
+    0   :   otherwise
+**/
+static int __w4uCapIsSignature(const uint8_t* p)
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+        if (!isalnum(p[i]) && '_' != p[i])
+            return 0;
+
+    return 1;
+}
+
+/** __w4uCapAddTable()
+Synopsis
+    static BOOL __w4uCapAddTable(const uint8_t* pTbl, uint32_t size);
+Description
+    Append a copy of an ACPI table, RSDP, RSDT and XSDT are skipped since they are synthesized
+Paramters
+    const uint8_t* pTbl : table
+    uint32_t size       : size of the table data, at least the header Length
+Returns
+    1   :   success or skipped
+    0   :   out of memory
+**/
+static BOOL __w4uCapAddTable(const uint8_t* pTbl, uint32_t size)
+{
+    void* pCopy;
+
+    if (0 == memcmp(pTbl, "RSDT", 4) || 0 == memcmp(pTbl, "XSDT", 4) || 0 == memcmp(pTbl, "RSD ", 4))
+        return 1;
+
+    if (_w4uCapTables >= _w4uCapTablesMax)
+    {
+        uint32_t nMax = 0 == _w4uCapTablesMax ? 64 : 2 * _w4uCapTablesMax;
+        void** pNew = realloc(_w4uCapTable, nMax * sizeof(void*));
+
+        if (NULL == pNew)
+            return 0;
+
+        _w4uCapTable = pNew;
+        _w4uCapTablesMax = nMax;
+    }
+
+    if (NULL == (pCopy = malloc(size)))
+        return 0;
+
+    memcpy(pCopy, pTbl, size);
+    _w4uCapTable[_w4uCapTables++] = pCopy;
+
+    return 1;
+}
+
+/** __w4uCapTableLength()
+Synopsis
+    static uint32_t __w4uCapTableLength(const uint8_t* pTbl, uint32_t size);
+Description
+    Get the header Length of an ACPI table, if plausible
+Paramters
+    const uint8_t* pTbl : table
+    uint32_t size       : available data
+Returns
+    Length or 0, if not an ACPI table or truncated
+**/
+static uint32_t __w4uCapTableLength(const uint8_t* pTbl, uint32_t size)
+{
+    uint32_t Length;
+
+    if (size < 8 || !__w4uCapIsSignature(pTbl))
+        return 0;
+
+    memcpy(&Length, &pTbl[4], sizeof(Length));
+
+    if (Length < 8 || Length > size || Length > W4U_ACPI_TABLE_MAX_LENGTH)
+        return 0;
+
+    return Length;
+}
+
+/** __w4uCapParseAcpiDump()
+Synopsis
+    static BOOL __w4uCapParseAcpiDump(char* pszText);
+Description
+    Parse acpidump text output:
+
+        FACP @ 0x000000007FFE0000
+            0000: 46 41 43 50 F4 00 00 00 04 3F 42 4F 43 48 53 20  FACP.....?BOCHS
+            ...
+
+Paramters
+    char* pszText   : zero terminated file content, modified
+Returns
+    1   :   success
+    0   :   out of memory
+**/
+static BOOL __w4uCapParseAcpiDump(char* pszText)
+{
+    uint8_t* pTbl = NULL;
+    uint32_t sizeTbl = 0, sizeBuf = 0, Length;
+    BOOL nRet = 1;
+    char* pLine, * pNext, * p;
+
+    for (pLine = pszText; nRet && NULL != pLine; pLine = pNext)
+    {
+        if (NULL != (pNext = strchr(pLine, '\n')))
+            *pNext++ = '\0';
+
+        while (' ' == *pLine || '\t' == *pLine)
+            pLine++;
+
+        //
+        // "XXXX @ 0x...": next table
+        //
+        if (strlen(pLine) > 9 && 0 == memcmp(&pLine[4], " @ 0x", 5))
+        {
+            if (0 != (Length = __w4uCapTableLength(pTbl, sizeTbl)))
+                nRet = __w4uCapAddTable(pTbl, Length);
+
+            sizeTbl = 0;
+            continue;
+        }
+
+        //
+        // "hhhh: xx xx ... xx  ascii"
+        //
+        if (isxdigit((unsigned char)pLine[0]))
+        {
+            uint32_t Offset = (uint32_t)strtoul(pLine, &p, 16), k;
+
+            if (':' != *p++ || Offset >= W4U_ACPI_TABLE_MAX_LENGTH)
+                continue;
+
+            for (k = 0; k < 16 && ' ' == p[0] && isxdigit((unsigned char)p[1]) && isxdigit((unsigned char)p[2]); k++, p += 3)
+            {
+                char szHex[3] = { p[1], p[2], '\0' };
+
+                if (Offset + k + 1 > sizeBuf)
+                {
+                    uint8_t* pNew = realloc(pTbl, sizeBuf = 2 * (Offset + k + 1));
+
+                    if (NULL == pNew)
+                    {
+                        nRet = 0;
+                        break;
+                    }
+                    pTbl = pNew;
+                }
+
+                pTbl[Offset + k] = (uint8_t)strtoul(szHex, NULL, 16);
+
+                if (Offset + k + 1 > sizeTbl)
+                    sizeTbl = Offset + k + 1;
+            }
+        }
+    }
+
+    if (nRet && 0 != (Length = __w4uCapTableLength(pTbl, sizeTbl)))
+        nRet = __w4uCapAddTable(pTbl, Length);
+
+    free(pTbl);
+
+    return nRet;
+}
+
+/** W4UFirmwareCaptureAdd()
+Synopsis
+    BOOL W4UFirmwareCaptureAdd(const char* pszFile);
+Description
+    Load a capture file, the file type is detected by its content:
+        "_SM3_" or "_SM_"                   : SMBIOS entry point, major/minor version are taken
+        "XXXX @ 0x..."                      : acpidump text output
+        ACPI table header                   : one or more concatenated binary ACPI tables
+        otherwise                           : SMBIOS structure table, replaces a previous one
+
+    Tables are activated by W4UFirmwareCaptureInstall()
+Paramters
+    const char* pszFile : file name
+Returns
+    1   :   success
+    0   :   file not found, out of memory or unknown content
+**/
+BOOL W4UFirmwareCaptureAdd(const char* pszFile)
+{
+    FILE* fp = NULL;
+    uint8_t* pBuf = NULL;
+    uint32_t size = 0, off, Length;
+    char* pszText;
+    BOOL nRet = 0;
+
+    do {
+        if (NULL == (fp = fopen(pszFile, "rb")))
+            break;
+
+        fseek(fp, 0, SEEK_END);
+        size = (uint32_t)ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+
+        if (size < 8 || NULL == (pBuf = malloc(size + 1)))
+            break;
+
+        if (size != fread(pBuf, 1, size, fp))
+            break;
+
+        pBuf[size] = '\0';
+
+        if (0 == memcmp(pBuf, "_SM3_", 5))
+        {
+            SMBIOS_TABLE_3_0_ENTRY_POINT* pEntryPoint3 = (void*)pBuf;
+
+            _w4uCapSmbiosVersion[0] = pEntryPoint3->MajorVersion;
+            _w4uCapSmbiosVersion[1] = pEntryPoint3->MinorVersion;
+            _w4uCapSmbiosVersion[2] = size > offsetof(SMBIOS_TABLE_3_0_ENTRY_POINT, DocRev) ? pEntryPoint3->DocRev : 0;
+            nRet = 1;
+            break;
+        }
+
+        if (0 == memcmp(pBuf, "_SM_", 4))
+        {
+            SMBIOS_TABLE_ENTRY_POINT* pEntryPoint = (void*)pBuf;
+
+            _w4uCapSmbiosVersion[0] = pEntryPoint->MajorVersion;
+            _w4uCapSmbiosVersion[1] = pEntryPoint->MinorVersion;
+            _w4uCapSmbiosVersion[2] = 0;
+            nRet = 1;
+            break;
+        }
+
+        for (pszText = (char*)pBuf; isspace((unsigned char)*pszText); pszText++)
+            ;
+
+        if (strlen(pszText) > 9 && 0 == memcmp(&pszText[4], " @ 0x", 5))
+        {
+            nRet = __w4uCapParseAcpiDump(pszText);
+            break;
+        }
+
+        if (0 == memcmp(pBuf, "RSD PTR ", 8))
+        {
+            nRet = 1;                                               // acpixtract rsdp.dat, synthesized
+            break;
+        }
+
+        if (0 != __w4uCapTableLength(pBuf, size))
+        {
+            for (nRet = 1, off = 0; nRet && 0 != (Length = __w4uCapTableLength(&pBuf[off], size - off)); off += Length)
+                nRet = __w4uCapAddTable(&pBuf[off], Length);
+            break;
+        }
+
+        if (pBuf[1] >= 4)                                           // SMBIOS structure length
+        {
+            free(_w4uCapSmbios);
+            _w4uCapSmbios = pBuf;
+            _w4uCapSmbiosSize = size;
+            pBuf = NULL;
+            nRet = 1;
+        }
+
+    } while (0);
+
+    if (NULL != fp)
+        fclose(fp);
+
+    free(pBuf);
+
+    return nRet;
+}
+
+/** W4UFirmwareCaptureAddTable()
+Synopsis
+    BOOL W4UFirmwareCaptureAddTable(const void* pTable);
+Description
+    Add a copy of an ACPI table from memory, e.g. a synthetic table built by a test or benchmark.
+    Tables are activated by W4UFirmwareCaptureInstall()
+Paramters
+    const void* pTable  : ACPI table, the header Length is taken
+Returns
+    1   :   success
+    0   :   not an ACPI table or out of memory
+**/
+BOOL W4UFirmwareCaptureAddTable(const void* pTable)
+{
+    uint32_t Length;
+
+    if (NULL == pTable)
+        return 0;
+
+    memcpy(&Length, (const uint8_t*)pTable + 4, sizeof(Length));
+
+    if (0 == __w4uCapTableLength(pTable, Length))
+        return 0;
+
+    return __w4uCapAddTable(pTable, Length);
+}
+
+/** W4UFirmwareCaptureAddSmbios()
+Synopsis
+    BOOL W4UFirmwareCaptureAddSmbios(const void* pTable, uint32_t Size);
+Description
+    Add a copy of an SMBIOS structure table from memory, replaces a previous one.
+    Tables are activated by W4UFirmwareCaptureInstall()
+Paramters
+    const void* pTable  : SMBIOS structure table
+    uint32_t Size       : size in bytes
+Returns
+    1   :   success
+    0   :   out of memory
+**/
+BOOL W4UFirmwareCaptureAddSmbios(const void* pTable, uint32_t Size)
+{
+    uint8_t* pCopy;
+
+    if (NULL == pTable || 0 == Size || NULL == (pCopy = malloc(Size)))
+        return 0;
+
+    memcpy(pCopy, pTable, Size);
+
+    free(_w4uCapSmbios);
+    _w4uCapSmbios = pCopy;
+    _w4uCapSmbiosSize = Size;
+
+    return 1;
+}
+
+/** W4UFirmwareCaptureInstall()
+Synopsis
+    BOOL W4UFirmwareCaptureInstall(void);
+Description
+    Build RSDP, XSDT and SMBIOS 3.x entry point for the captured tables and install them as
+    firmware table provider. FADT DSDT/FACS pointers are redirected to the captured DSDT/FACS.
+Paramters
+    none
+Returns
+    1   :   success
+    0   :   nothing captured or out of memory
+**/
+BOOL W4UFirmwareCaptureInstall(void)
+{
+    static const EFI_GUID EfiAcpi20TableGuid = EFI_ACPI_20_TABLE_GUID;
+    static const EFI_GUID Smbios3TableGuid = SMBIOS3_TABLE_GUID;
+    EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE* pFADT = NULL;
+    EFI_ACPI_DESCRIPTION_HEADER* pHdr;
+    void* pDSDT = NULL, * pFACS = NULL;
+    uint32_t i, nEntries = 0, nConfigEntries = 0;
+    uint64_t qwAddress;
+
+    free(_w4uCapXsdt);
+    _w4uCapXsdt = NULL;
+
+    for (i = 0; i < _w4uCapTables; i++)
+    {
+        pHdr = _w4uCapTable[i];
+
+        if ('TDSD' == pHdr->Signature && NULL == pDSDT)
+            pDSDT = pHdr;
+        else if ('SCAF' == pHdr->Signature && NULL == pFACS)
+            pFACS = pHdr;
+        else
+        {
+            if ('PCAF' == pHdr->Signature && NULL == pFADT)
+                pFADT = (void*)pHdr;
+            nEntries++;
+        }
+    }
+
+    if (0 != _w4uCapTables)
+    {
+        if (NULL == (_w4uCapXsdt = calloc(1, sizeof(EFI_ACPI_DESCRIPTION_HEADER) + nEntries * sizeof(uint64_t))))
+            return 0;
+
+        //
+        // XSDT: all tables but DSDT and FACS, in capture order
+        //
+        _w4uCapXsdt->Signature = 'TDSX';
+        _w4uCapXsdt->Length = (uint32_t)(sizeof(EFI_ACPI_DESCRIPTION_HEADER) + nEntries * sizeof(uint64_t));
+        _w4uCapXsdt->Revision = 1;
+        memcpy(_w4uCapXsdt->OemId, "W4UCAP", 6);
+
+        for (nEntries = 0, i = 0; i < _w4uCapTables; i++)
+        {
+            if (_w4uCapTable[i] == pDSDT || _w4uCapTable[i] == pFACS)
+                continue;
+
+            qwAddress = (size_t)_w4uCapTable[i];
+            memcpy((uint8_t*)_w4uCapXsdt + sizeof(EFI_ACPI_DESCRIPTION_HEADER) + nEntries++ * sizeof(uint64_t), &qwAddress, sizeof(qwAddress));
+        }
+
+        _w4uCapXsdt->Checksum = (uint8_t)(0 - __w4uAcpiChecksum(_w4uCapXsdt, _w4uCapXsdt->Length));
+
+        //
+        // FADT: redirect DSDT and FACS, 32 bit pointers only below 4GB
+        //
+        if (NULL != pFADT)
+        {
+            if (pFADT->Header.Length >= offsetof(EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE, XDsdt) + sizeof(uint64_t))
+                pFADT->XDsdt = (size_t)pDSDT;
+            if (pFADT->Header.Length >= offsetof(EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE, XFirmwareCtrl) + sizeof(uint64_t))
+                pFADT->XFirmwareCtrl = (size_t)pFACS;
+
+            pFADT->Dsdt = (uint64_t)(size_t)pDSDT > 0xFFFFFFFFULL ? 0 : (uint32_t)(size_t)pDSDT;
+            pFADT->FirmwareCtrl = (uint64_t)(size_t)pFACS > 0xFFFFFFFFULL ? 0 : (uint32_t)(size_t)pFACS;
+
+            pFADT->Header.Checksum = 0;
+            pFADT->Header.Checksum = (uint8_t)(0 - __w4uAcpiChecksum(pFADT, pFADT->Header.Length));
+        }
+
+        //
+        // RSDP: ACPI 2.0+, XSDT only
+        //
+        memset(&_w4uCapRsdp, 0, sizeof(_w4uCapRsdp));
+        _w4uCapRsdp.Signature = EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER_SIGNATURE;
+        memcpy(_w4uCapRsdp.OemId, "W4UCAP", 6);
+        _w4uCapRsdp.Revision = 2;
+        _w4uCapRsdp.Length = sizeof(_w4uCapRsdp);
+        _w4uCapRsdp.XsdtAddress = (size_t)_w4uCapXsdt;
+        _w4uCapRsdp.Checksum = (uint8_t)(0 - __w4uAcpiChecksum(&_w4uCapRsdp, 20));
+        _w4uCapRsdp.ExtendedChecksum = (uint8_t)(0 - __w4uAcpiChecksum(&_w4uCapRsdp, sizeof(_w4uCapRsdp)));
+
+        _w4uCapConfigTable[nConfigEntries].VendorGuid = EfiAcpi20TableGuid;
+        _w4uCapConfigTable[nConfigEntries++].VendorTable = &_w4uCapRsdp;
+    }
+
+    if (NULL != _w4uCapSmbios)
+    {
+        memset(&_w4uCapSmbios3, 0, sizeof(_w4uCapSmbios3));
+        memcpy(_w4uCapSmbios3.AnchorString, "_SM3_", 5);
+        _w4uCapSmbios3.EntryPointLength = sizeof(_w4uCapSmbios3);
+        _w4uCapSmbios3.MajorVersion = _w4uCapSmbiosVersion[0];
+        _w4uCapSmbios3.MinorVersion = _w4uCapSmbiosVersion[1];
+        _w4uCapSmbios3.DocRev = _w4uCapSmbiosVersion[2];
+        _w4uCapSmbios3.EntryPointRevision = 1;
+        _w4uCapSmbios3.TableMaximumSize = _w4uCapSmbiosSize;
+        _w4uCapSmbios3.TableAddress = (size_t)_w4uCapSmbios;
+        _w4uCapSmbios3.EntryPointStructureChecksum = (uint8_t)(0 - __w4uAcpiChecksum(&_w4uCapSmbios3, sizeof(_w4uCapSmbios3)));
+
+        _w4uCapConfigTable[nConfigEntries].VendorGuid = Smbios3TableGuid;
+        _w4uCapConfigTable[nConfigEntries++].VendorTable = &_w4uCapSmbios3;
+    }
+
+    if (0 == nConfigEntries)
+        return 0;
+
+    return W4USetFirmwareTableProvider(_w4uCapConfigTable, nConfigEntries);
+}
+
+/** W4UFirmwareCaptureReset()
+Synopsis
+    void W4UFirmwareCaptureReset(void);
+Description
+    Restore the EFI system table as firmware table provider and release all captured tables
+Paramters
+    none
+Returns
+    none
+**/
+void W4UFirmwareCaptureReset(void)
+{
+    uint32_t i;
+
+    W4USetFirmwareTableProvider(NULL, 0);
+
+    for (i = 0; i < _w4uCapTables; i++)
+        free(_w4uCapTable[i]);
+
+    free(_w4uCapTable);
+    free(_w4uCapXsdt);
+    free(_w4uCapSmbios);
+
+    _w4uCapTable = NULL;
+    _w4uCapTables = 0;
+    _w4uCapTablesMax = 0;
+    _w4uCapXsdt = NULL;
+    _w4uCapSmbios = NULL;
+    _w4uCapSmbiosSize = 0;
+    _w4uCapSmbiosVersion[0] = 3;
+    _w4uCapSmbiosVersion[1] = 0;
+    _w4uCapSmbiosVersion[2] = 0;
+}
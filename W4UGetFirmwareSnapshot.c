@@ -0,0 +1,207 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    W4UGetFirmwareSnapshot.c
+
+Abstract:
+
+    Snapshot of all firmware tables into one contiguous buffer, extension to GetSystemFirmwareTable()
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <Protocol\AcpiSystemDescriptionTable.h>
+#include "LibWin324UEFI.h"
+
+/** __w4uSnapshotAdd()
+Synopsis
+    static uint32_t __w4uSnapshotAdd(W4USNAPSHOTHDR* pHdr, uint32_t Size, uint32_t Offset, uint32_t Provider, uint32_t Signature, uint32_t Instance, const void* pTbl, uint32_t Length);
+Description
+    Add a directory entry and copy the table, if pHdr != NULL
+Paramters
+    W4USNAPSHOTHDR* pHdr    : snapshot buffer or NULL to calculate the size only
+    uint32_t Size           : snapshot buffer size, the directory size is taken from pHdr->HeaderSize
+    uint32_t Offset         : current data offset, 0 if a previous table didn't fit
+    uint32_t Provider       : 'ACPI' or 'RSMB'
+    uint32_t Signature      : table signature
+    uint32_t Instance       : instance of that signature
+    const void* pTbl        : table
+    uint32_t Length         : table length
+Returns
+    next data offset, 8 byte aligned, 0 if the table or its directory entry doesn't fit
+**/
+static uint32_t __w4uSnapshotAdd(W4USNAPSHOTHDR* pHdr, uint32_t Size, uint32_t Offset, uint32_t Provider, uint32_t Signature, uint32_t Instance, const void* pTbl, uint32_t Length)
+{
+    uint32_t Next = (Offset + Length + 7) & ~7U;
+
+    if (0 == Offset || Next < Offset)
+        return 0;
+
+    if (NULL != pHdr)
+    {
+        W4USNAPSHOTENTRY* pEntry = &((W4USNAPSHOTENTRY*)&pHdr[1])[pHdr->nEntries];
+
+        if (Next > Size || (uint8_t*)&pEntry[1] > (uint8_t*)pHdr + pHdr->HeaderSize)
+            return 0;                                               // index rebuilt since the snapshot was sized
+
+        pHdr->nEntries++;
+        pEntry->ProviderSignature = Provider;
+        pEntry->Signature = Signature;
+        pEntry->Instance = Instance;
+        pEntry->Offset = Offset;
+        pEntry->Length = Length;
+        pEntry->Reserved = 0;
+        pEntry->PhysicalAddress = (size_t)pTbl;
+
+        memcpy((uint8_t*)pHdr + Offset, pTbl, Length);
+        memset((uint8_t*)pHdr + Offset + Length, 0, Next - Offset - Length);   // deterministic padding
+    }
+
+    return Next;
+}
+
+/** __w4uSnapshotWalk()
+Synopsis
+    static uint32_t __w4uSnapshotWalk(W4UACPIINDEX* pIndex, W4USMBIOSINDEX* pSmbios, W4USNAPSHOTHDR* pHdr, uint32_t Size, uint32_t nEntries, uint32_t* pnEntries);
+Description
+    Walk RSDP, all ACPI tables grouped by signature and the SMBIOS structure table
+Paramters
+    W4UACPIINDEX* pIndex    : ACPI table index
+    W4USMBIOSINDEX* pSmbios : SMBIOS structure index
+    W4USNAPSHOTHDR* pHdr    : snapshot buffer or NULL to calculate the size only
+    uint32_t Size           : snapshot buffer size
+    uint32_t nEntries       : size of the directory in entries
+    uint32_t* pnEntries     : number of tables
+Returns
+    total size, 0 if the tables don't fit into Size
+**/
+static uint32_t __w4uSnapshotWalk(W4UACPIINDEX* pIndex, W4USMBIOSINDEX* pSmbios, W4USNAPSHOTHDR* pHdr, uint32_t Size, uint32_t nEntries, uint32_t* pnEntries)
+{
+    uint32_t Offset = (uint32_t)(sizeof(W4USNAPSHOTHDR) + nEntries * sizeof(W4USNAPSHOTENTRY));
+    uint32_t i, n = 0, Instance = 0, Signature = 0;
+
+    Offset = (Offset + 7) & ~7U;
+
+    if (NULL != pIndex->pRSDP)
+    {
+        EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER* pRSD = pIndex->pRSDP;
+
+        Offset = __w4uSnapshotAdd(pHdr, Size, Offset, 'ACPI', 'PDSR', 0, pRSD, pRSD->Revision >= 2 ? pRSD->Length : 20);
+        n++;
+    }
+
+    //
+    // Order[] groups the tables by signature, instances are numbered within a group
+    //
+    for (i = 0; i < pIndex->nTables; i++)
+    {
+        EFI_ACPI_2_0_COMMON_HEADER* pTbl = pIndex->pTable[pIndex->Order[i]];
+
+        if (Signature != pTbl->Signature)
+        {
+            Signature = pTbl->Signature;                            // next group
+            Instance = 0;
+        }
+
+        if (_w4uAcpiValidation && W4U_ACPI_VALID != W4UValidateAcpiTable(pTbl))
+            continue;                                               // validation mode, invalid table
+
+        Offset = __w4uSnapshotAdd(pHdr, Size, Offset, 'ACPI', Signature, Instance++, pTbl, pTbl->Length);
+        n++;
+    }
+
+    if (NULL != pSmbios->pTable)
+    {
+        Offset = __w4uSnapshotAdd(pHdr, Size, Offset, 'RSMB', 0, 0, pSmbios->pTable, pSmbios->TableLength);
+        n++;
+    }
+
+    *pnEntries = n;
+
+    return Offset;
+}
+
+/** W4UGetFirmwareSnapshot()
+Synopsis
+    uint32_t W4UGetFirmwareSnapshot(void* pBuffer, uint32_t BufferSize, void** ppSnapshot);
+Description
+    Copy all firmware tables into one contiguous buffer, ready to be written to a file at once:
+
+        W4USNAPSHOTHDR      : signature 'W4US', sizes, SMBIOS version
+        W4USNAPSHOTENTRY[]  : provider, signature, instance, offset, length and physical address of each table
+        table data          : 8 byte aligned
+
+    Tables: RSDP ('PDSR'), all ACPI tables incl. XSDT, DSDT and FACS grouped by signature, XSDT order within a group,
+    SMBIOS structure table ('RSMB', no RAWSMBIOSDATA header).
+    In validation mode, see W4USetAcpiValidation(), ACPI tables that fail W4UValidateAcpiTable() are omitted,
+    and instances are numbered over the tables in the snapshot.
+
+        size = W4UGetFirmwareSnapshot(NULL, 0, &pSnapshot);
+        WriteFile(hFile, pSnapshot, size, &dwWritten, NULL);
+        free(pSnapshot);
+Paramters
+    void* pBuffer       : caller provided buffer or NULL
+    uint32_t BufferSize : buffer size
+    void** ppSnapshot   : if not NULL, receives a buffer allocated by malloc(), to be released by free()
+Returns
+    size of the snapshot in bytes, the snapshot is copied only if it fits into BufferSize or ppSnapshot is given
+    0 if ppSnapshot is given and out of memory
+**/
+uint32_t W4UGetFirmwareSnapshot(void* pBuffer, uint32_t BufferSize, void** ppSnapshot)
+{
+    W4UACPIINDEX* pIndex = __w4uGetAcpiIndex();
+    W4USMBIOSINDEX* pSmbios = __w4uGetSmbiosIndex();
+    W4USNAPSHOTHDR* pHdr = pBuffer;
+    uint32_t nEntries, sizeTotal, Generation;
+
+    do {
+        Generation = pIndex->Generation;
+
+        //
+        // the directory size is known after a first pass, the data size does not depend on it
+        //
+        sizeTotal = __w4uSnapshotWalk(pIndex, pSmbios, NULL, 0, 0, &nEntries);
+        sizeTotal += (uint32_t)(nEntries * sizeof(W4USNAPSHOTENTRY));
+
+        if (NULL != ppSnapshot)
+        {
+            if (NULL == (*ppSnapshot = pHdr = malloc(sizeTotal)))
+                return 0;
+        }
+        else if (NULL == pBuffer || BufferSize < sizeTotal)
+            return sizeTotal;
+
+        memset(pHdr, 0, sizeof(W4USNAPSHOTHDR));
+        pHdr->Signature = W4U_SNAPSHOT_SIGNATURE;
+        pHdr->HeaderSize = (uint32_t)(sizeof(W4USNAPSHOTHDR) + nEntries * sizeof(W4USNAPSHOTENTRY));
+        pHdr->TotalSize = sizeTotal;
+        pHdr->SmbiosMajorVersion = pSmbios->MajorVersion;
+        pHdr->SmbiosMinorVersion = pSmbios->MinorVersion;
+        pHdr->DmiRevision = pSmbios->DmiRevision;
+
+        //
+        // validation mode may rebuild a stale index during the walk, size it again then
+        //
+        if (sizeTotal == __w4uSnapshotWalk(pIndex, pSmbios, pHdr, sizeTotal, nEntries, &nEntries)
+            && Generation == pIndex->Generation)
+            break;
+
+        if (NULL != ppSnapshot)
+            free(pHdr);
+
+    } while (1);
+
+    return sizeTotal;
+}
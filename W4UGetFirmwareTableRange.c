@@ -0,0 +1,109 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    W4UGetFirmwareTableRange.c
+
+Abstract:
+
+    Offset-ranged, chunked reads of firmware tables, extension to GetSystemFirmwareTable()
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "LibWin324UEFI.h"
+
+/** W4UGetFirmwareTableRange()
+Synopsis
+    uint32_t W4UGetFirmwareTableRange(uint32_t FirmwareTableProviderSignature, uint32_t FirmwareTableID, uint32_t Instance,
+                                      uint32_t Offset, void* pBuffer, uint32_t BufferSize, uint32_t* pTableSize);
+Description
+    Copy the byte range [Offset, Offset + BufferSize) of a firmware table to pBuffer.
+    The range is truncated at the end of the table, so a large DSDT can be read
+    through a small, fixed size buffer:
+
+        for (Offset = 0; 0 != (n = W4UGetFirmwareTableRange('ACPI', 'TDSD', 0, Offset, Buf, sizeof(Buf), NULL)); Offset += n)
+            ...
+
+    'ACPI'  : any table by signature incl. XSDT, DSDT and FACS, Instance selects
+              the n-th table with that signature, e.g. the n-th SSDT
+    'RSMB'  : offsets refer to the data returned by GetSystemFirmwareTable('RSMB', ...),
+              the RAWSMBIOSDATA header followed by the SMBIOS structure table.
+              FirmwareTableID and Instance must be 0
+Paramters
+    uint32_t FirmwareTableProviderSignature : 'ACPI' or 'RSMB'
+    uint32_t FirmwareTableID                : table signature, e.g. 'TDSD'
+    uint32_t Instance                       : 0 for the first table of that signature, 1 for the second...
+    uint32_t Offset                         : offset of the first byte to copy
+    void* pBuffer                           : buffer
+    uint32_t BufferSize                     : buffer size, maximum number of bytes to copy
+    uint32_t* pTableSize                    : optional, total size of the table, 0 if not found
+Returns
+    number of bytes copied, 0 if the table was not found or Offset is at or beyond the end of the table
+**/
+uint32_t W4UGetFirmwareTableRange(uint32_t FirmwareTableProviderSignature, uint32_t FirmwareTableID, uint32_t Instance,
+                                  uint32_t Offset, void* pBuffer, uint32_t BufferSize, uint32_t* pTableSize)
+{
+    RAWSMBIOSDATA RawHdr;
+    const uint8_t* pTbl = NULL;
+    uint32_t sizeTbl = 0, sizeHdr = 0, nCopy = 0, nHdr = 0;
+
+    do {
+
+        if (0 == W4UGetFirmwareTableView(FirmwareTableProviderSignature, FirmwareTableID, Instance, (const void**)&pTbl, &sizeTbl))
+            break;
+
+        if ('RSMB' == FirmwareTableProviderSignature)
+        {
+            W4USMBIOSINDEX* pSmbios = __w4uGetSmbiosIndex();
+
+            RawHdr.Used20CallingMethod = 0;
+            RawHdr.SMBIOSMajorVersion = pSmbios->MajorVersion;
+            RawHdr.SMBIOSMinorVersion = pSmbios->MinorVersion;
+            RawHdr.DmiRevision = pSmbios->DmiRevision;
+            RawHdr.Length = sizeTbl;
+
+            sizeHdr = sizeof(RAWSMBIOSDATA);
+        }
+
+        if (NULL == pBuffer || Offset >= sizeHdr + sizeTbl)
+            break;
+
+        nCopy = sizeHdr + sizeTbl - Offset;
+
+        if (nCopy > BufferSize)
+            nCopy = BufferSize;
+
+        //
+        // RSMB only: the part of the RAWSMBIOSDATA header within the range
+        //
+        if (Offset < sizeHdr)
+        {
+            nHdr = sizeHdr - Offset < nCopy ? sizeHdr - Offset : nCopy;
+            memcpy(pBuffer, (uint8_t*)&RawHdr + Offset, nHdr);
+        }
+
+        //
+        // the part of the table within the range, none if the range ends within the header
+        //
+        if (nCopy > nHdr)
+            memcpy((uint8_t*)pBuffer + nHdr, &pTbl[Offset + nHdr - sizeHdr], nCopy - nHdr);
+
+    } while (0);
+
+    if (NULL != pTableSize)
+        *pTableSize = sizeHdr + sizeTbl;
+
+    return nCopy;
+}
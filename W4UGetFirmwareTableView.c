@@ -0,0 +1,84 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    W4UGetFirmwareTableView.c
+
+Abstract:
+
+    Zero-copy access to firmware tables, extension to GetSystemFirmwareTable()
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <Protocol\AcpiSystemDescriptionTable.h>
+#include "LibWin324UEFI.h"
+
+/** W4UGetFirmwareTableView()
+Synopsis
+    BOOL W4UGetFirmwareTableView(uint32_t FirmwareTableProviderSignature, uint32_t FirmwareTableID, uint32_t Instance, const void** ppTable, uint32_t* pSize);
+Description
+    Get address and size of a firmware table in memory, without copying it.
+    The table must not be modified by the caller.
+    In validation mode, see W4USetAcpiValidation(), ACPI tables that fail W4UValidateAcpiTable() are not returned.
+
+    'ACPI'  : any table by signature incl. XSDT, DSDT and FACS, Instance selects
+              the n-th table with that signature, e.g. the n-th SSDT
+    'RSMB'  : the SMBIOS 3.x or 2.x structure table, FirmwareTableID and Instance must be 0.
+              NOTE: other than GetSystemFirmwareTable(), there is no RAWSMBIOSDATA header
+Paramters
+    uint32_t FirmwareTableProviderSignature : 'ACPI' or 'RSMB'
+    uint32_t FirmwareTableID                : table signature, e.g. 'TDSD'
+    uint32_t Instance                       : 0 for the first table of that signature, 1 for the second...
+    const void** ppTable                    : table address
+    uint32_t* pSize                         : table size in bytes
+Returns
+    1   :   success
+    0   :   table not found
+**/
+BOOL W4UGetFirmwareTableView(uint32_t FirmwareTableProviderSignature, uint32_t FirmwareTableID, uint32_t Instance, const void** ppTable, uint32_t* pSize)
+{
+    const void* pTbl = NULL;
+    uint32_t sizeTbl = 0;
+
+    if ('ACPI' == FirmwareTableProviderSignature)
+    {
+        pTbl = __w4uAcpiFindTable(FirmwareTableID, Instance);
+
+        if (NULL != pTbl && _w4uAcpiValidation && W4U_ACPI_VALID != W4UValidateAcpiTable(pTbl))
+            pTbl = NULL;                                            // validation mode, invalid table
+
+        if (NULL != pTbl)
+            sizeTbl = ((EFI_ACPI_2_0_COMMON_HEADER*)pTbl)->Length;
+    }
+
+    if ('RSMB' == FirmwareTableProviderSignature && 0 == FirmwareTableID && 0 == Instance)
+    {
+        W4USMBIOSINDEX* pSmbios = __w4uGetSmbiosIndex();
+
+        pTbl = pSmbios->pTable;
+        sizeTbl = pSmbios->TableLength;
+    }
+
+    if (NULL == pTbl)
+        return 0;
+
+    if (NULL != ppTable)
+        *ppTable = pTbl;
+
+    if (NULL != pSize)
+        *pSize = sizeTbl;
+
+    return 1;
+}
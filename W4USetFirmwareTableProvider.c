@@ -0,0 +1,182 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    W4USetFirmwareTableProvider.c
+
+Abstract:
+
+    Pluggable source of the EFI configuration table for the firmware table providers
+
+    The ACPI table index and the SMBIOS structure index locate RSDP and SMBIOS entry points
+    in the configuration table returned by __w4uGetConfigurationTable(). By default this
+    is the EFI system table's configuration table, W4USetFirmwareTableProvider() replaces it,
+    e.g. by a synthetic configuration table of captured firmware tables, see W4UFirmwareCapture.c
+
+    InstallConfigurationTable() signals the event group of the table's GUID. Notify functions for the
+    ACPI and SMBIOS GUIDs mark the indices stale, so tables installed or uninstalled at runtime,
+    e.g. by EFI_ACPI_TABLE_PROTOCOL, are picked up on next use.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <Guid\Acpi.h>
+#include <Guid\SmBios.h>
+#include "LibWin324UEFI.h"
+
+extern EFI_SYSTEM_TABLE* _cdegST;
+
+static EFI_CONFIGURATION_TABLE* _w4uConfigTable;   // NULL: EFI system table
+static uint32_t _w4uConfigTableEntries;
+static EFI_EVENT _w4uTableEvent[3];                 // ACPI 2.0, SMBIOS 2.x, SMBIOS 3.x configuration table events
+
+/** __w4uAcpiTableNotify()
+Synopsis
+    static VOID EFIAPI __w4uAcpiTableNotify(EFI_EVENT Event, VOID* Context);
+Description
+    ACPI configuration table installed, changed or removed
+Paramters
+    EFI_EVENT Event : event
+    VOID* Context   : not used
+Returns
+    none
+**/
+static VOID EFIAPI __w4uAcpiTableNotify(EFI_EVENT Event, VOID* Context)
+{
+    __w4uAcpiIndexInvalidate();
+}
+
+/** __w4uSmbiosTableNotify()
+Synopsis
+    static VOID EFIAPI __w4uSmbiosTableNotify(EFI_EVENT Event, VOID* Context);
+Description
+    SMBIOS configuration table installed, changed or removed
+Paramters
+    EFI_EVENT Event : event
+    VOID* Context   : not used
+Returns
+    none
+**/
+static VOID EFIAPI __w4uSmbiosTableNotify(EFI_EVENT Event, VOID* Context)
+{
+    __w4uSmbiosIndexInvalidate();
+}
+
+/** __w4uTableEventsAtExit()
+Synopsis
+    static void __w4uTableEventsAtExit(void);
+Description
+    Close the configuration table events, the notify functions are gone with the image
+Paramters
+    none
+Returns
+    none
+**/
+static void __w4uTableEventsAtExit(void)
+{
+    int i;
+
+    for (i = 0; i < sizeof(_w4uTableEvent) / sizeof(_w4uTableEvent[0]); i++)
+    {
+        if (NULL != _w4uTableEvent[i])
+            _cdegST->BootServices->CloseEvent(_w4uTableEvent[i]);
+
+        _w4uTableEvent[i] = NULL;
+    }
+}
+
+/** __w4uTableEventsRegister()
+Synopsis
+    static void __w4uTableEventsRegister(void);
+Description
+    Register for the ACPI and SMBIOS configuration table event groups, UEFI 2.0 and later.
+    Without events, changes are still detected by the XSDT and SMBIOS entry point generation stamps.
+Paramters
+    none
+Returns
+    none
+**/
+static void __w4uTableEventsRegister(void)
+{
+    static const EFI_GUID EfiAcpi20TableGuid = EFI_ACPI_20_TABLE_GUID;
+    static const EFI_GUID SmbiosTableGuid = SMBIOS_TABLE_GUID;
+    static const EFI_GUID Smbios3TableGuid = SMBIOS3_TABLE_GUID;
+    EFI_BOOT_SERVICES* pBS = _cdegST->BootServices;
+
+    if (_cdegST->Hdr.Revision < EFI_2_00_SYSTEM_TABLE_REVISION)
+        return;
+
+    pBS->CreateEventEx(EVT_NOTIFY_SIGNAL, TPL_CALLBACK, __w4uAcpiTableNotify, NULL, &EfiAcpi20TableGuid, &_w4uTableEvent[0]);
+    pBS->CreateEventEx(EVT_NOTIFY_SIGNAL, TPL_CALLBACK, __w4uSmbiosTableNotify, NULL, &SmbiosTableGuid, &_w4uTableEvent[1]);
+    pBS->CreateEventEx(EVT_NOTIFY_SIGNAL, TPL_CALLBACK, __w4uSmbiosTableNotify, NULL, &Smbios3TableGuid, &_w4uTableEvent[2]);
+
+    atexit(__w4uTableEventsAtExit);
+}
+
+/** __w4uGetConfigurationTable()
+Synopsis
+    void* __w4uGetConfigurationTable(uint32_t* pnEntries);
+Description
+    Get the configuration table used by the firmware table providers
+Paramters
+    uint32_t* pnEntries : number of EFI_CONFIGURATION_TABLE entries
+Returns
+    pointer to the EFI_CONFIGURATION_TABLE array
+**/
+void* __w4uGetConfigurationTable(uint32_t* pnEntries)
+{
+    static int fEvents;
+
+    if (0 == fEvents)
+    {
+        fEvents = 1;
+        __w4uTableEventsRegister();
+    }
+
+    if (NULL != _w4uConfigTable)
+    {
+        *pnEntries = _w4uConfigTableEntries;
+        return _w4uConfigTable;
+    }
+
+    *pnEntries = (uint32_t)_cdegST->NumberOfTableEntries;
+
+    return _cdegST->ConfigurationTable;
+}
+
+/** W4USetFirmwareTableProvider()
+Synopsis
+    BOOL W4USetFirmwareTableProvider(void* pConfigurationTable, uint32_t nEntries);
+Description
+    Replace the EFI configuration table used by GetSystemFirmwareTable(), EnumSystemFirmwareTables()
+    and the W4U firmware table extensions. ACPI and SMBIOS indices are rebuilt on next use.
+
+    NOTE: the configuration table and all tables referenced by it must remain valid
+          until the provider is replaced again
+Paramters
+    void* pConfigurationTable   : EFI_CONFIGURATION_TABLE array, NULL to restore the EFI system table
+    uint32_t nEntries           : number of entries
+Returns
+    1   :   success
+**/
+BOOL W4USetFirmwareTableProvider(void* pConfigurationTable, uint32_t nEntries)
+{
+    _w4uConfigTable = pConfigurationTable;
+    _w4uConfigTableEntries = NULL == pConfigurationTable ? 0 : nEntries;
+
+    __w4uAcpiIndexReset();
+    __w4uSmbiosIndexReset();
+
+    return 1;
+}
@@ -0,0 +1,108 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    W4USmbios.c
+
+Abstract:
+
+    SMBIOS structure lookup by type and by handle, extension to GetSystemFirmwareTable('RSMB', ...)
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "LibWin324UEFI.h"
+
+/** W4USmbiosCount()
+Synopsis
+    uint32_t W4USmbiosCount(uint8_t Type);
+Description
+    Get the number of SMBIOS structures of a given type
+Paramters
+    uint8_t Type    : structure type, e.g. 17 for memory devices
+Returns
+    number of structures
+**/
+uint32_t W4USmbiosCount(uint8_t Type)
+{
+    return __w4uGetSmbiosIndex()->CountOfType[Type];
+}
+
+/** W4USmbiosFindByType()
+Synopsis
+    const W4USMBIOSENTRY* W4USmbiosFindByType(uint8_t Type, uint32_t Instance);
+Description
+    Find a SMBIOS structure by type
+
+        for (i = 0; NULL != (pEntry = W4USmbiosFindByType(4, i)); i++)
+            printf("%s\n", W4USmbiosGetString(pEntry, pEntry->pStruct[4]));  // processor socket designation
+Paramters
+    uint8_t Type        : structure type
+    uint32_t Instance   : 0 for the first structure of that type, 1 for the second...
+Returns
+    pointer to the structure entry or NULL, if not found
+**/
+const W4USMBIOSENTRY* W4USmbiosFindByType(uint8_t Type, uint32_t Instance)
+{
+    W4USMBIOSINDEX* pIndex = __w4uGetSmbiosIndex();
+
+    if (Instance >= pIndex->CountOfType[Type])
+        return NULL;
+
+    return &pIndex->pEntry[pIndex->pTypeOrder[pIndex->FirstOfType[Type] + Instance]];
+}
+
+/** W4USmbiosFindByHandle()
+Synopsis
+    const W4USMBIOSENTRY* W4USmbiosFindByHandle(uint16_t Handle);
+Description
+    Find a SMBIOS structure by handle, e.g. the type 16 physical memory array
+    referenced by a type 17 memory device
+Paramters
+    uint16_t Handle : structure handle
+Returns
+    pointer to the structure entry or NULL, if not found
+**/
+const W4USMBIOSENTRY* W4USmbiosFindByHandle(uint16_t Handle)
+{
+    W4USMBIOSINDEX* pIndex = __w4uGetSmbiosIndex();
+    uint32_t idx;
+
+    if (NULL == pIndex->pHandleHash)
+        return NULL;
+
+    idx = pIndex->pHandleHash[__w4uSmbiosHandleSlot(pIndex, Handle)];
+
+    return 0 == idx ? NULL : &pIndex->pEntry[idx - 1];
+}
+
+/** W4USmbiosGetString()
+Synopsis
+    const char* W4USmbiosGetString(const W4USMBIOSENTRY* pEntry, uint8_t StringNumber);
+Description
+    Get a string of a SMBIOS structure
+Paramters
+    const W4USMBIOSENTRY* pEntry    : structure entry
+    uint8_t StringNumber            : string number from the formatted area, 1 based
+Returns
+    pointer to the string in the structure table or NULL, if StringNumber is 0 or out of range
+**/
+const char* W4USmbiosGetString(const W4USMBIOSENTRY* pEntry, uint8_t StringNumber)
+{
+    W4USMBIOSINDEX* pIndex = __w4uGetSmbiosIndex();
+
+    if (NULL == pEntry || 0 == StringNumber || StringNumber > pEntry->nStrings)
+        return NULL;
+
+    return (const char*)&pEntry->pStruct[pIndex->pStringOffset[pEntry->FirstString + StringNumber - 1]];
+}
@@ -0,0 +1,206 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    W4UValidateAcpiTable.c
+
+Abstract:
+
+    ACPI table validation: checksum, header length and XSDT entries
+
+    The checksum is computed with AVX2 or SSE2 PSADBW horizontal byte sums.
+    Results for tables in the ACPI table index are cached.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <intrin.h>
+#include <Protocol\AcpiSystemDescriptionTable.h>
+#include "LibWin324UEFI.h"
+
+int _w4uAcpiValidation;                         // 1: don't return invalid tables
+
+/** __w4uChecksumSse2()
+Synopsis
+    static uint32_t __w4uChecksumSse2(const uint8_t* p, uint32_t len);
+Description
+    Sum of all bytes, SSE2 PSADBW 16 bytes per iteration
+Paramters
+    const uint8_t* p    : data
+    uint32_t len        : length in bytes
+Returns
+    sum, only the lower 8 bits are significant
+**/
+static uint32_t __w4uChecksumSse2(const uint8_t* p, uint32_t len)
+{
+    __m128i sum0 = _mm_setzero_si128(), sum1 = _mm_setzero_si128(), zero = _mm_setzero_si128();
+    uint32_t i = 0, s;
+
+    for (; i + 32 <= len; i += 32)
+    {
+        sum0 = _mm_add_epi64(sum0, _mm_sad_epu8(_mm_loadu_si128((const __m128i*)&p[i]), zero));
+        sum1 = _mm_add_epi64(sum1, _mm_sad_epu8(_mm_loadu_si128((const __m128i*)&p[i + 16]), zero));
+    }
+
+    sum0 = _mm_add_epi64(sum0, sum1);
+    s = (uint32_t)_mm_cvtsi128_si32(sum0) + (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(sum0, 8));
+
+    for (; i < len; i++)
+        s += p[i];
+
+    return s;
+}
+
+/** __w4uChecksumAvx2()
+Synopsis
+    static uint32_t __w4uChecksumAvx2(const uint8_t* p, uint32_t len);
+Description
+    Sum of all bytes, AVX2 VPSADBW 64 bytes per iteration
+Paramters
+    const uint8_t* p    : data
+    uint32_t len        : length in bytes
+Returns
+    sum, only the lower 8 bits are significant
+**/
+static uint32_t __w4uChecksumAvx2(const uint8_t* p, uint32_t len)
+{
+    __m256i sum0 = _mm256_setzero_si256(), sum1 = _mm256_setzero_si256(), zero = _mm256_setzero_si256();
+    __m128i sum;
+    uint32_t i = 0, s;
+
+    for (; i + 64 <= len; i += 64)
+    {
+        sum0 = _mm256_add_epi64(sum0, _mm256_sad_epu8(_mm256_loadu_si256((const __m256i*)&p[i]), zero));
+        sum1 = _mm256_add_epi64(sum1, _mm256_sad_epu8(_mm256_loadu_si256((const __m256i*)&p[i + 32]), zero));
+    }
+
+    sum0 = _mm256_add_epi64(sum0, sum1);
+    sum = _mm_add_epi64(_mm256_castsi256_si128(sum0), _mm256_extracti128_si256(sum0, 1));
+    s = (uint32_t)_mm_cvtsi128_si32(sum) + (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+
+    return s + __w4uChecksumSse2(&p[i], len - i);
+}
+
+/** __w4uAcpiChecksum()
+Synopsis
+    uint8_t __w4uAcpiChecksum(const void* pData, uint32_t len);
+Description
+    Compute the 8 bit ACPI checksum, AVX2 if available, SSE2 otherwise
+Paramters
+    const void* pData   : data
+    uint32_t len        : length in bytes
+Returns
+    8 bit sum of all bytes, 0 for a valid ACPI table
+**/
+uint8_t __w4uAcpiChecksum(const void* pData, uint32_t len)
+{
+    static int fAvx2 = -1;
+
+    if (-1 == fAvx2)
+        fAvx2 = __w4uHasAvx2();
+
+    return (uint8_t)(fAvx2 ? __w4uChecksumAvx2(pData, len) : __w4uChecksumSse2(pData, len));
+}
+
+/** W4UValidateAcpiTable()
+Synopsis
+    uint32_t W4UValidateAcpiTable(const void* pTable);
+Description
+    Validate an ACPI table:
+        W4U_ACPI_BAD_LENGTH     : Length below the header size or above W4U_ACPI_TABLE_MAX_LENGTH
+        W4U_ACPI_BAD_CHECKSUM   : checksum not 0, FACS has no checksum
+        W4U_ACPI_BAD_XSDT_ENTRY : XSDT length not a multiple of 8 entries or NULL entry
+
+    The result is cached for tables in the ACPI table index, e.g. returned by W4UGetFirmwareTableView()
+Paramters
+    const void* pTable  : ACPI table
+Returns
+    W4U_ACPI_VALID or W4U_ACPI_BAD_xyz bits
+**/
+uint32_t W4UValidateAcpiTable(const void* pTable)
+{
+    const EFI_ACPI_DESCRIPTION_HEADER* pHdr = pTable;
+    W4UACPIINDEX* pIndex = __w4uGetAcpiIndex();
+    int idx = __w4uAcpiTableIndex(pTable);
+    uint32_t nRet = W4U_ACPI_VALID, i, nEntries;
+
+    if (idx >= 0 && 0 != pIndex->Status[idx] && pIndex->Stamp[idx] == __w4uAcpiStamp(pTable))
+        return pIndex->Status[idx] & ~W4U_ACPI_VALIDATED;          // cached result, table unchanged
+
+    do {
+        if ('SCAF' == pHdr->Signature)
+        {
+            if (pHdr->Length < 64 || pHdr->Length > W4U_ACPI_TABLE_MAX_LENGTH)
+                nRet |= W4U_ACPI_BAD_LENGTH;                        // FACS: no checksum, minimum 64 bytes
+            break;
+        }
+
+        if (pHdr->Length < sizeof(EFI_ACPI_DESCRIPTION_HEADER) || pHdr->Length > W4U_ACPI_TABLE_MAX_LENGTH)
+        {
+            nRet |= W4U_ACPI_BAD_LENGTH;
+            break;                                                  // don't touch bytes beyond a bad length
+        }
+
+        if (0 != __w4uAcpiChecksum(pTable, pHdr->Length))
+            nRet |= W4U_ACPI_BAD_CHECKSUM;
+
+        if ('TDSX' == pHdr->Signature)
+        {
+            nEntries = (pHdr->Length - sizeof(EFI_ACPI_DESCRIPTION_HEADER)) / sizeof(uint64_t);
+
+            if (0 != (pHdr->Length - sizeof(EFI_ACPI_DESCRIPTION_HEADER)) % sizeof(uint64_t))
+                nRet |= W4U_ACPI_BAD_XSDT_ENTRY;
+
+            for (i = 0; i < nEntries; i++)
+            {
+                uint64_t qwAddress;
+
+                memcpy(&qwAddress, (uint8_t*)pTable + sizeof(EFI_ACPI_DESCRIPTION_HEADER) + i * sizeof(uint64_t), sizeof(qwAddress));
+
+                if (0 == qwAddress)
+                    nRet |= W4U_ACPI_BAD_XSDT_ENTRY;
+            }
+        }
+
+    } while (0);
+
+    if (idx >= 0)
+    {
+        pIndex->Status[idx] = (uint8_t)(nRet | W4U_ACPI_VALIDATED);
+        pIndex->Stamp[idx] = __w4uAcpiStamp(pTable);
+    }
+
+    return nRet;
+}
+
+/** W4USetAcpiValidation()
+Synopsis
+    BOOL W4USetAcpiValidation(BOOL fEnable);
+Description
+    Enable or disable the validation mode. In validation mode GetSystemFirmwareTable(),
+    W4UGetFirmwareTableView(), W4UGetFirmwareTableRange() and W4UAcpiIterNext()
+    don't return ACPI tables that fail W4UValidateAcpiTable().
+Paramters
+    BOOL fEnable    : 1 to enable, 0 to disable
+Returns
+    previous setting
+**/
+BOOL W4USetAcpiValidation(BOOL fEnable)
+{
+    BOOL fPrev = _w4uAcpiValidation;
+
+    _w4uAcpiValidation = 0 != fEnable;
+
+    return fPrev;
+}
@@ -0,0 +1,121 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    WaitForSingleObject.c
+
+Abstract:
+
+    Win32 API WaitForSingleObject() for UEFI
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "LibWin324UEFI.h"
+
+extern DWORD _w4udwLastError;
+
+/** __w4uWaitTimeout()
+Synopsis
+    static void __w4uWaitTimeout(W4UWHEELNODE* pNode);
+Description
+    Timer wheel expire function of the time-out interval
+Paramters
+    W4UWHEELNODE* pNode : node, Context points to the time-out flag
+Returns
+    none
+**/
+static void __w4uWaitTimeout(W4UWHEELNODE* pNode)
+{
+    *(volatile int*)pNode->Context = 1;
+}
+
+/** WaitForSingleObject()
+Synopsis
+    DWORD WaitForSingleObject(
+      [in] HANDLE hHandle,
+      [in] DWORD  dwMilliseconds
+    );
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-waitforsingleobject#syntax
+Description
+    Waits until the specified object is in the signaled state or the time-out interval elapses.
+    Waitable timers from CreateWaitableTimerA()/W() are supported, a synchronization timer
+    is reset by a successful wait. File handles are always signaled, file I/O is synchronous.
+
+    The time-out interval is a timer wheel node too, at TPL_APPLICATION the CPU halts until
+    the next node expires.
+Paramters
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-waitforsingleobject#parameters
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-waitforsingleobject#return-value
+**/
+DWORD WINAPI _w4uWaitForSingleObject(
+    _In_ HANDLE hHandle,
+    _In_ DWORD dwMilliseconds
+)
+{
+    W4UTIMER* pTimer = hHandle;
+    W4UWHEELNODE Timeout = { NULL, NULL, 0, __w4uWaitTimeout, NULL };
+    volatile int fTimeout = 0;
+    DWORD dwRet = WAIT_FAILED;
+
+    do {
+
+        if (NULL == pTimer || INVALID_HANDLE_VALUE == pTimer)
+        {
+            _w4udwLastError = ERROR_INVALID_HANDLE;
+            break;
+        }
+
+        if (WIN324UEFI_ID == pTimer->signature)
+        {
+            dwRet = WAIT_OBJECT_0;
+            break;
+        }
+
+        if (W4UTIMER_ID != pTimer->signature)
+        {
+            _w4udwLastError = ERROR_INVALID_HANDLE;
+            break;
+        }
+
+        if (0 != dwMilliseconds && INFINITE != dwMilliseconds)
+        {
+            Timeout.Context = (void*)&fTimeout;
+            __w4uWheelArm(&Timeout, __w4uClockTickCount() + 1 + dwMilliseconds);
+        }
+
+        for (;;)
+        {
+            if (pTimer->fManualReset ? 0 != pTimer->fSignaled : 0 != InterlockedExchange(&pTimer->fSignaled, 0))
+            {
+                dwRet = WAIT_OBJECT_0;
+                break;
+            }
+
+            if (0 == dwMilliseconds || 0 != fTimeout)
+            {
+                dwRet = WAIT_TIMEOUT;
+                break;
+            }
+
+            __w4uWheelWait();
+        }
+
+        __w4uWheelCancel(&Timeout);
+
+    } while (0);
+
+    return dwRet;
+}
+
+void* __imp_WaitForSingleObject = (void*)_w4uWaitForSingleObject;
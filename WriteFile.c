@@ -33,13 +33,20 @@ static BOOL WINAPI _w4uWriteFile(
 )
 {
     W4UFILE* pw4uFile = hFile;
-    size_t size;
+    size_t size = 0;
     BOOL fRet = 0;
+    uint64_t tscStart = NULL != _w4uTraceBuf ? __w4uTraceTimestamp() : 0;
+    uint64_t pos = 0;
 
     if (WIN324UEFI_ID == pw4uFile->signature)
     {
-        if ((GENERIC_WRITE | GENERIC_ALL) & pw4uFile->dwDesiredAccess)
+        if (NULL == pw4uFile->pFile)                    // directory handle
+            _w4udwLastError = ERROR_INVALID_FUNCTION;
+        else if ((GENERIC_WRITE | GENERIC_ALL) & pw4uFile->dwDesiredAccess)
         {
+            if (NULL != _w4uTraceBuf)
+                pos = (uint64_t)ftell(pw4uFile->pFile);
+
             size = fwrite(lpBuffer, 1, nNumberOfBytesToWrite, pw4uFile->pFile);
 
             if (NULL != lpNumberOfBytesWritten)
@@ -57,6 +64,9 @@ static BOOL WINAPI _w4uWriteFile(
         _w4udwLastError = ERROR_INVALID_HANDLE;
     }
 
+    if (NULL != _w4uTraceBuf)
+        __w4uTraceRecord(W4UTRACE_WRITE, pw4uFile, nNumberOfBytesToWrite, pos, size, tscStart, NULL);
+
     return fRet;
 }
 
@@ -18,13 +18,21 @@ Author:
 
 --*/
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
+#include <intrin.h>
+#include "LibWin324UEFI.h"
 
-typedef struct _TABLEACPISIGNATURE {
+//
+// ACPI table IDs are the index into ACPISigs[], 0 is W4U_ACPI_SIG_UNKNOWN
+//
+typedef union _TABLEACPISIGNATURE {
     char Signature[4];
+    uint32_t Sig;
 }TABLEACPISIGNATURE;
 
-static TABLEACPISIGNATURE ACPISigs[] = {
+static const TABLEACPISIGNATURE ACPISigs[W4U_ACPI_SIG_COUNT + 1] = {
+    {0, 0, 0, 0},
     {'A', 'P', 'I', 'C'},
     {'B', 'E', 'R', 'T'},
     {'B', 'G', 'R', 'T'},
@@ -86,11 +94,142 @@ static TABLEACPISIGNATURE ACPISigs[] = {
     {'X', 'E', 'N', 'V'},
 };
 
+//
+// perfect hash: (Sig * W4U_ACPI_SIG_MUL) >> (32 - W4U_ACPI_SIG_BITS) is distinct for all signatures above.
+// ACPISigSlot[] holds the table ID for each slot, 0 for an empty slot.
+// The 3 padding bytes allow 32 bit gathers of the last slots.
+// NOTE: adding a signature requires a new multiplier and slot table
+//
+#define W4U_ACPI_SIG_MUL    0xD8ABF2E3U
+#define W4U_ACPI_SIG_BITS   7
+
+static const uint8_t ACPISigSlot[(1 << W4U_ACPI_SIG_BITS) + 3] = {
+     0,  0,  0,  0,  0, 26,  7,  0,  0, 10,  0, 59, 39,  0,  0, 46,
+    40, 15,  0, 23,  0,  0,  0, 33,  0,  0,  0, 44, 52, 29,  0, 54,
+     0, 48,  0,  0,  0,  0,  5,  0,  0,  0,  0,  0,  0,  0, 30,  0,
+     0,  0, 50,  6,  9,  1,  0, 53,  0,  0, 21, 55, 57, 27,  2,  0,
+     0, 12, 13,  0,  0, 43,  0,  0, 18,  0, 32, 56,  0, 36, 19, 38,
+    20, 51, 25, 34,  0,  0, 35,  0,  0,  0,  8, 45,  0,  0, 31,  0,
+     0,  0, 49, 17,  0,  0, 42, 24, 14, 37,  3,  0,  4,  0,  0,  0,
+    22,  0,  0,  0,  0,  0, 58,  0,  0, 41,  0, 47, 16, 11,  0, 28,
+     0,  0,  0
+};
+
+/** W4UAcpiSignatureId()
+Synopsis
+    uint32_t W4UAcpiSignatureId(uint32_t Signature);
+Description
+    Classify a 4 byte signature, e.g. 'TDSD', as an ACPI 6.2 table signature.
+    A single hash probe and compare, no search.
+Paramters
+    uint32_t Signature  : signature as read from memory
+Returns
+    table ID 1 ... W4U_ACPI_SIG_COUNT
+    W4U_ACPI_SIG_UNKNOWN if not an ACPI table signature
+**/
+uint32_t W4UAcpiSignatureId(uint32_t Signature)
+{
+    uint32_t Id = ACPISigSlot[(Signature * W4U_ACPI_SIG_MUL) >> (32 - W4U_ACPI_SIG_BITS)];
+
+    return Signature == ACPISigs[Id].Sig ? Id : W4U_ACPI_SIG_UNKNOWN;
+}
+
+/** W4UAcpiSignatureName()
+Synopsis
+    uint32_t W4UAcpiSignatureName(uint32_t Id);
+Description
+    Get the signature of a table ID returned by W4UAcpiSignatureId() or W4UAcpiClassifySignatures()
+Paramters
+    uint32_t Id : table ID
+Returns
+    signature, 0 for W4U_ACPI_SIG_UNKNOWN or an invalid ID
+**/
+uint32_t W4UAcpiSignatureName(uint32_t Id)
+{
+    return Id <= W4U_ACPI_SIG_COUNT ? ACPISigs[Id].Sig : 0;
+}
+
+/** __w4uAcpiClassifyAvx2()
+Synopsis
+    static uint32_t __w4uAcpiClassifyAvx2(const uint32_t* pSig, uint32_t nSig, uint8_t* pId);
+Description
+    Classify 8 signatures per iteration: VPMULLD hash, VPGATHERDD of slot and signature, VPCMPEQD
+Paramters
+    const uint32_t* pSig    : signatures
+    uint32_t nSig           : number of signatures, multiple of 8
+    uint8_t* pId            : table IDs
+Returns
+    number of ACPI table signatures
+**/
+static uint32_t __w4uAcpiClassifyAvx2(const uint32_t* pSig, uint32_t nSig, uint8_t* pId)
+{
+    const __m256i mul = _mm256_set1_epi32((int)W4U_ACPI_SIG_MUL);
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    __m256i sig, slot, id, ref;
+    uint32_t i, j, nFound = 0, Ids[8];
+
+    for (i = 0; i < nSig; i += 8)
+    {
+        sig = _mm256_loadu_si256((const __m256i*)&pSig[i]);
+        slot = _mm256_srli_epi32(_mm256_mullo_epi32(sig, mul), 32 - W4U_ACPI_SIG_BITS);
+        id = _mm256_and_si256(_mm256_i32gather_epi32((const int*)ACPISigSlot, slot, 1), mask);
+        ref = _mm256_i32gather_epi32((const int*)ACPISigs, id, 4);
+        id = _mm256_and_si256(id, _mm256_cmpeq_epi32(sig, ref));
+
+        _mm256_storeu_si256((__m256i*)Ids, id);
+
+        for (j = 0; j < 8; j++)
+        {
+            pId[i + j] = (uint8_t)Ids[j];
+            nFound += 0 != Ids[j];
+        }
+    }
+
+    return nFound;
+}
+
+/** W4UAcpiClassifySignatures()
+Synopsis
+    uint32_t W4UAcpiClassifySignatures(const uint32_t* pSig, uint32_t nSig, uint8_t* pId);
+Description
+    Classify an array of 4 byte words, e.g. while scanning memory for ACPI tables.
+    pId[i] receives the table ID of pSig[i] or W4U_ACPI_SIG_UNKNOWN.
+    8 words per iteration with AVX2, if available.
+Paramters
+    const uint32_t* pSig    : signatures
+    uint32_t nSig           : number of signatures
+    uint8_t* pId            : table IDs, nSig entries
+Returns
+    number of ACPI table signatures
+**/
+uint32_t W4UAcpiClassifySignatures(const uint32_t* pSig, uint32_t nSig, uint8_t* pId)
+{
+    static int fAvx2 = -1;
+    uint32_t i = 0, nFound = 0;
+
+    if (-1 == fAvx2)
+        fAvx2 = __w4uHasAvx2();
+
+    if (fAvx2)
+    {
+        i = nSig & ~7U;
+        nFound = __w4uAcpiClassifyAvx2(pSig, i, pId);
+    }
+
+    for (; i < nSig; i++)
+    {
+        pId[i] = (uint8_t)W4UAcpiSignatureId(pSig[i]);
+        nFound += W4U_ACPI_SIG_UNKNOWN != pId[i];
+    }
+
+    return nFound;
+}
+
 /** __ChkACPISignature()
 Synopsis
     int __ChkACPISignature(char Sig[4]);
 Description
-    Retrieves the specified firmware table from the firmware table provider.
+    Check if 4 Byte signature belongs to ACPI 6.2 table signatures
 Paramters
     char Sig[4] :   pointer to signatur
 Returns
@@ -100,16 +239,9 @@ Returns
 
 int __ChkACPISignature(char Sig[4])
 {
-    size_t i = 0;
-    int found = 0;
+    uint32_t Signature;
 
-    for (i = 0; i < sizeof(ACPISigs) / sizeof(ACPISigs[0]); i++)
-    {
-        if (0 == strncmp(Sig, ACPISigs[i].Signature, 4))
-        {
-            found = 1;
-            break;
-        }
-    }
-    return found;
-}
\ No newline at end of file
+    memcpy(&Signature, Sig, sizeof(Signature));
+
+    return W4U_ACPI_SIG_UNKNOWN != W4UAcpiSignatureId(Signature);
+}
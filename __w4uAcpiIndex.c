@@ -0,0 +1,480 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    __w4uAcpiIndex.c
+
+Abstract:
+
+    ACPI table index shared by GetSystemFirmwareTable() and EnumSystemFirmwareTables()
+
+    The EFI configuration table, see __w4uGetConfigurationTable(), and the XSDT are scanned once, on first use.
+    Subsequent table lookups are a signature hash probe.
+
+    The index is rebuilt, if the ACPI configuration table event was signaled or the XSDT length or checksum
+    changed, e.g. by EFI_ACPI_TABLE_PROTOCOL.InstallAcpiTable(). Validation results of unchanged tables are kept.
+
+    NOTE: the rebuild is complete, not limited to the changed XSDT entries. Order[] keeps the tables of
+          a signature consecutive, an installed or removed table shifts the ranges of other signatures.
+          A rebuild is one pass over the XSDT plus an address hash to take over validation results, O(n),
+          and tables change at runtime rarely, e.g. once when a driver installs its SSDT.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <Guid\Acpi.h>
+#include <Protocol\AcpiSystemDescriptionTable.h>
+#include "LibWin324UEFI.h"
+
+#define IsEqualGUID(rguid1, rguid2) (!memcmp(rguid1, rguid2, sizeof(GUID))) //guiddef.h
+#define ACPI_ADDR_SLOT(p, Bits) ((uint32_t)(((uint64_t)(size_t)(p) >> 3) * 0x9E3779B97F4A7C15ULL >> (64 - (Bits))))
+
+static W4UACPIINDEX _w4uAcpiIndex;
+static int _w4uAcpiIndexValid;
+static volatile int _w4uAcpiIndexStale;            // set by the ACPI configuration table event
+static uint32_t _w4uAcpiGeneration;
+
+/** __w4uAcpiHashSlot()
+Synopsis
+    static uint32_t __w4uAcpiHashSlot(W4UACPIINDEX* pIndex, uint32_t Signature);
+Description
+    Get the hash slot of a signature, linear probing
+Paramters
+    W4UACPIINDEX* pIndex    : ACPI table index
+    uint32_t Signature      : table signature, e.g. 'PCAF'
+Returns
+    slot that holds Signature or the empty slot to insert Signature
+**/
+static uint32_t __w4uAcpiHashSlot(W4UACPIINDEX* pIndex, uint32_t Signature)
+{
+    uint32_t slot = (Signature * 0x9E3779B1U) >> (32 - pIndex->HashBits);
+
+    while (0 != pIndex->pHash[slot].Signature && Signature != pIndex->pHash[slot].Signature)
+        slot = (slot + 1) & ((1U << pIndex->HashBits) - 1);
+
+    return slot;
+}
+
+/** __w4uAcpiIndexAdd()
+Synopsis
+    static void* __w4uAcpiIndexAdd(W4UACPIINDEX* pIndex, uint64_t qwAddress);
+Description
+    Append a table to the index
+Paramters
+    W4UACPIINDEX* pIndex    : ACPI table index
+    uint64_t qwAddress      : table address
+Returns
+    table address or NULL, if qwAddress is 0 or the signature is 0
+**/
+static void* __w4uAcpiIndexAdd(W4UACPIINDEX* pIndex, uint64_t qwAddress)
+{
+    void* pTbl = (void*)(size_t)qwAddress;
+
+    if (NULL == pTbl || pIndex->nTables >= pIndex->nTablesMax)
+        return NULL;
+
+    if (0 == ((EFI_ACPI_2_0_COMMON_HEADER*)pTbl)->Signature)
+        return NULL;                            // signature 0 marks empty hash slots
+
+    pIndex->pTable[pIndex->nTables++] = pTbl;
+
+    return pTbl;
+}
+
+/** __w4uAcpiIndexFree()
+Synopsis
+    static void __w4uAcpiIndexFree(W4UACPIINDEX* pIndex);
+Description
+    Release the arrays of an ACPI table index
+Paramters
+    W4UACPIINDEX* pIndex    : ACPI table index
+Returns
+    none
+**/
+static void __w4uAcpiIndexFree(W4UACPIINDEX* pIndex)
+{
+    free(pIndex->pTable);
+    free(pIndex->Order);
+    free(pIndex->Status);
+    free(pIndex->Stamp);
+    free(pIndex->pHash);
+    pIndex->pTable = NULL;
+    pIndex->Order = NULL;
+    pIndex->Status = NULL;
+    pIndex->Stamp = NULL;
+    pIndex->pHash = NULL;
+    pIndex->nTables = pIndex->nXsdtTables = pIndex->nTablesMax = 0;
+}
+
+/** __w4uAcpiIndexBuild()
+Synopsis
+    static void __w4uAcpiIndexBuild(W4UACPIINDEX* pIndex);
+Description
+    Scan EFI configuration table, XSDT and FADT and build the signature hash.
+    Tables of the same signature are stored consecutively in Order[], in XSDT order.
+    The arrays are sized from the XSDT entry count, the hash to at least twice that.
+Paramters
+    W4UACPIINDEX* pIndex    : ACPI table index
+Returns
+    none
+**/
+static void __w4uAcpiIndexBuild(W4UACPIINDEX* pIndex)
+{
+    static const EFI_GUID EfiAcpi20TableGuid = EFI_ACPI_20_TABLE_GUID;
+    EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER* pRSD = NULL;
+    EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE* pFADT = NULL;
+    EFI_CONFIGURATION_TABLE* pConfigTable;
+    EFI_ACPI_2_0_COMMON_HEADER* pXSDT;
+    uint64_t* pEntry;
+    uint32_t i, slot, First, nConfigEntries, nEntries;
+
+    __w4uAcpiIndexFree(pIndex);
+    memset(pIndex, 0, sizeof(W4UACPIINDEX));
+
+    pIndex->Generation = ++_w4uAcpiGeneration;
+
+    pConfigTable = __w4uGetConfigurationTable(&nConfigEntries);
+
+    for (i = 0; i < nConfigEntries; i++)
+    {
+        if (IsEqualGUID(&EfiAcpi20TableGuid, &pConfigTable[i].VendorGuid))
+        {
+            pRSD = pConfigTable[i].VendorTable;
+            break;
+        }
+    }
+
+    if (NULL == pRSD)
+        return;
+
+    pIndex->pRSDP = pRSD;
+    pIndex->pXSDT = pXSDT = (void*)(size_t)pRSD->XsdtAddress;
+
+    if (NULL == pXSDT)
+        return;
+
+    if (pXSDT->Length < sizeof(EFI_ACPI_DESCRIPTION_HEADER) || pXSDT->Length > W4U_ACPI_TABLE_MAX_LENGTH)
+        return;                                                     // corrupt XSDT, empty index
+
+    //
+    // size the index from the XSDT entry count, + XSDT, DSDT and FACS
+    //
+    nEntries = (pXSDT->Length - sizeof(EFI_ACPI_DESCRIPTION_HEADER)) / sizeof(uint64_t);
+
+    pIndex->nTablesMax = nEntries + 3;
+
+    for (pIndex->HashBits = 4; (1U << pIndex->HashBits) < 2 * pIndex->nTablesMax; pIndex->HashBits++)
+        ;
+
+    pIndex->pTable = malloc(sizeof(void*) * pIndex->nTablesMax);
+    pIndex->Order = malloc(sizeof(uint32_t) * pIndex->nTablesMax);
+    pIndex->Status = calloc(pIndex->nTablesMax, sizeof(uint8_t));
+    pIndex->Stamp = malloc(sizeof(uint64_t) * pIndex->nTablesMax);
+    pIndex->pHash = calloc((size_t)1 << pIndex->HashBits, sizeof(W4UACPIHASH));
+
+    if (NULL == pIndex->pTable || NULL == pIndex->Order || NULL == pIndex->Status || NULL == pIndex->Stamp || NULL == pIndex->pHash)
+    {
+        __w4uAcpiIndexFree(pIndex);                                 // out of memory, empty index
+        return;
+    }
+
+    //
+    // XSDT entries are 64 bit addresses, not necessarily 8 byte aligned
+    //
+    pEntry = (void*)&((char*)pXSDT)[sizeof(EFI_ACPI_DESCRIPTION_HEADER)];
+
+    for (i = 0; i < nEntries; i++)
+    {
+        uint64_t qwAddress;
+
+        memcpy(&qwAddress, &pEntry[i], sizeof(qwAddress));
+
+        if (0 == qwAddress)
+            continue;                                               // unused entry
+
+        if (NULL != __w4uAcpiIndexAdd(pIndex, qwAddress)
+            && 'PCAF' == ((EFI_ACPI_2_0_COMMON_HEADER*)(size_t)qwAddress)->Signature)
+            pFADT = (void*)(size_t)qwAddress;
+    }
+
+    pIndex->nXsdtTables = pIndex->nTables;
+
+    //
+    // XSDT, DSDT and FACS are not listed in the XSDT, but looked up by signature too
+    // NOTE: the 64 bit X_DSDT/X_FIRMWARE_CTRL take precedence, if present
+    //
+    __w4uAcpiIndexAdd(pIndex, (size_t)pXSDT);
+
+    if (NULL != pFADT)
+    {
+        pIndex->pFADT = pFADT;
+
+        if (pFADT->Header.Length >= offsetof(EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE, XDsdt) + sizeof(uint64_t) && 0 != pFADT->XDsdt)
+            pIndex->pDSDT = __w4uAcpiIndexAdd(pIndex, pFADT->XDsdt);
+        else
+            pIndex->pDSDT = __w4uAcpiIndexAdd(pIndex, pFADT->Dsdt);
+
+        if (pFADT->Header.Length >= offsetof(EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE, XFirmwareCtrl) + sizeof(uint64_t) && 0 != pFADT->XFirmwareCtrl)
+            pIndex->pFACS = __w4uAcpiIndexAdd(pIndex, pFADT->XFirmwareCtrl);
+        else
+            pIndex->pFACS = __w4uAcpiIndexAdd(pIndex, pFADT->FirmwareCtrl);
+    }
+
+    //
+    // count instances per signature, assign consecutive Order[] ranges, then fill them
+    //
+    for (i = 0; i < pIndex->nTables; i++)
+    {
+        uint32_t Signature = ((EFI_ACPI_2_0_COMMON_HEADER*)pIndex->pTable[i])->Signature;
+
+        slot = __w4uAcpiHashSlot(pIndex, Signature);
+        pIndex->pHash[slot].Signature = Signature;
+        pIndex->pHash[slot].nInstances++;
+    }
+
+    for (First = 0, slot = 0; slot < (1U << pIndex->HashBits); slot++)
+    {
+        pIndex->pHash[slot].First = First;
+        First += pIndex->pHash[slot].nInstances;
+        pIndex->pHash[slot].nInstances = 0;
+    }
+
+    for (i = 0; i < pIndex->nTables; i++)
+    {
+        slot = __w4uAcpiHashSlot(pIndex, ((EFI_ACPI_2_0_COMMON_HEADER*)pIndex->pTable[i])->Signature);
+        pIndex->Order[pIndex->pHash[slot].First + pIndex->pHash[slot].nInstances++] = i;
+        pIndex->Stamp[i] = __w4uAcpiStamp(pIndex->pTable[i]);
+    }
+
+    pIndex->XsdtStamp = __w4uAcpiStamp(pXSDT);
+}
+
+/** __w4uAcpiIndexRebuild()
+Synopsis
+    static void __w4uAcpiIndexRebuild(W4UACPIINDEX* pIndex);
+Description
+    Rebuild the index after a change of the ACPI tables, completely, see NOTE above.
+    Validation results are taken over for tables at the same address with the same stamp,
+    the previous tables are looked up by an address hash.
+Paramters
+    W4UACPIINDEX* pIndex    : ACPI table index
+Returns
+    none
+**/
+static void __w4uAcpiIndexRebuild(W4UACPIINDEX* pIndex)
+{
+    W4UACPIINDEX Prev;
+    uint32_t* pAddrHash;                                            // Prev.pTable[] index + 1, 0: empty slot
+    uint32_t i, j, slot, Bits;
+
+    memcpy(&Prev, pIndex, sizeof(W4UACPIINDEX));                   // Prev owns the previous arrays
+    memset(pIndex, 0, sizeof(W4UACPIINDEX));
+
+    __w4uAcpiIndexBuild(pIndex);
+
+    for (Bits = 4; (1U << Bits) < 2 * Prev.nTables; Bits++)
+        ;
+
+    pAddrHash = calloc((size_t)1 << Bits, sizeof(uint32_t));
+
+    if (NULL != pAddrHash)                                          // out of memory: tables are validated again
+    {
+        for (j = 0; j < Prev.nTables; j++)
+        {
+            for (slot = ACPI_ADDR_SLOT(Prev.pTable[j], Bits); 0 != pAddrHash[slot]; slot = (slot + 1) & ((1U << Bits) - 1))
+                ;
+            pAddrHash[slot] = j + 1;
+        }
+
+        for (i = 0; i < pIndex->nTables; i++)
+        {
+            for (slot = ACPI_ADDR_SLOT(pIndex->pTable[i], Bits); 0 != pAddrHash[slot]; slot = (slot + 1) & ((1U << Bits) - 1))
+            {
+                j = pAddrHash[slot] - 1;
+
+                if (pIndex->pTable[i] == Prev.pTable[j])
+                {
+                    if (pIndex->Stamp[i] == Prev.Stamp[j])
+                        pIndex->Status[i] = Prev.Status[j];
+                    break;
+                }
+            }
+        }
+    }
+
+    free(pAddrHash);
+    __w4uAcpiIndexFree(&Prev);
+}
+
+/** __w4uGetAcpiIndex()
+Synopsis
+    W4UACPIINDEX* __w4uGetAcpiIndex(void);
+Description
+    Get the ACPI table index, build it on first use, rebuild it after a change
+Paramters
+    none
+Returns
+    pointer to the ACPI table index
+**/
+W4UACPIINDEX* __w4uGetAcpiIndex(void)
+{
+    W4UACPIINDEX* pIndex = &_w4uAcpiIndex;
+
+    if (0 == _w4uAcpiIndexValid)
+    {
+        __w4uAcpiIndexBuild(pIndex);
+        _w4uAcpiIndexValid = 1;
+        _w4uAcpiIndexStale = 0;
+    }
+    else if (_w4uAcpiIndexStale || (NULL != pIndex->pXSDT
+        && (pIndex->XsdtStamp != __w4uAcpiStamp(pIndex->pXSDT)
+            || (size_t)((EFI_ACPI_2_0_ROOT_SYSTEM_DESCRIPTION_POINTER*)pIndex->pRSDP)->XsdtAddress != (size_t)pIndex->pXSDT)))
+    {
+        _w4uAcpiIndexStale = 0;                                     // before the rebuild, don't miss a new event
+        __w4uAcpiIndexRebuild(pIndex);
+    }
+
+    return pIndex;
+}
+
+/** __w4uAcpiIndexReset()
+Synopsis
+    void __w4uAcpiIndexReset(void);
+Description
+    Discard the ACPI table index, it is rebuilt on next use
+Paramters
+    none
+Returns
+    none
+**/
+void __w4uAcpiIndexReset(void)
+{
+    _w4uAcpiIndexValid = 0;
+}
+
+/** __w4uAcpiIndexInvalidate()
+Synopsis
+    void __w4uAcpiIndexInvalidate(void);
+Description
+    Mark the ACPI table index stale, it is rebuilt on next use, validation results of unchanged tables are kept
+Paramters
+    none
+Returns
+    none
+**/
+void __w4uAcpiIndexInvalidate(void)
+{
+    _w4uAcpiIndexStale = 1;
+}
+
+/** __w4uAcpiStamp()
+Synopsis
+    uint64_t __w4uAcpiStamp(const void* pTable);
+Description
+    Get the generation stamp of an ACPI table: checksum and length.
+    A producer that changes a table recalculates its checksum, a change that keeps
+    both length and checksum is not detected.
+Paramters
+    const void* pTable  : ACPI table
+Returns
+    stamp
+**/
+uint64_t __w4uAcpiStamp(const void* pTable)
+{
+    const EFI_ACPI_DESCRIPTION_HEADER* pHdr = pTable;
+
+    if (NULL == pTable)
+        return 0;
+
+    return (uint64_t)pHdr->Checksum << 32 | pHdr->Length;
+}
+
+/** __w4uAcpiFindTable()
+Synopsis
+    void* __w4uAcpiFindTable(uint32_t Signature, uint32_t Instance);
+Description
+    Find an ACPI table by signature
+Paramters
+    uint32_t Signature  : table signature, e.g. 'TDSS'
+    uint32_t Instance   : 0 for the first table of that signature, 1 for the second...
+Returns
+    pointer to the table or NULL, if not found
+**/
+void* __w4uAcpiFindTable(uint32_t Signature, uint32_t Instance)
+{
+    W4UACPIINDEX* pIndex = __w4uGetAcpiIndex();
+    uint32_t slot;
+
+    if (0 == Signature || NULL == pIndex->pHash)
+        return NULL;
+
+    slot = __w4uAcpiHashSlot(pIndex, Signature);
+
+    if (Instance >= pIndex->pHash[slot].nInstances)
+        return NULL;
+
+    return pIndex->pTable[pIndex->Order[pIndex->pHash[slot].First + Instance]];
+}
+
+/** __w4uAcpiCountTables()
+Synopsis
+    uint32_t __w4uAcpiCountTables(uint32_t Signature);
+Description
+    Get the number of ACPI tables with a given signature
+Paramters
+    uint32_t Signature  : table signature, e.g. 'TDSS'
+Returns
+    number of tables
+**/
+uint32_t __w4uAcpiCountTables(uint32_t Signature)
+{
+    W4UACPIINDEX* pIndex = __w4uGetAcpiIndex();
+
+    if (0 == Signature || NULL == pIndex->pHash)
+        return 0;
+
+    return pIndex->pHash[__w4uAcpiHashSlot(pIndex, Signature)].nInstances;
+}
+
+/** __w4uAcpiTableIndex()
+Synopsis
+    int __w4uAcpiTableIndex(const void* pTable);
+Description
+    Get the index of a table in W4UACPIINDEX.pTable[]
+Paramters
+    const void* pTable  : table address
+Returns
+    index or -1, if pTable is not an indexed ACPI table
+**/
+int __w4uAcpiTableIndex(const void* pTable)
+{
+    W4UACPIINDEX* pIndex = __w4uGetAcpiIndex();
+    uint32_t slot, i;
+
+    if (NULL == pTable || NULL == pIndex->pHash)
+        return -1;
+
+    slot = __w4uAcpiHashSlot(pIndex, ((EFI_ACPI_2_0_COMMON_HEADER*)pTable)->Signature);
+
+    for (i = 0; i < pIndex->pHash[slot].nInstances; i++)
+    {
+        uint32_t idx = pIndex->Order[pIndex->pHash[slot].First + i];
+
+        if (pTable == pIndex->pTable[idx])
+            return (int)idx;
+    }
+
+    return -1;
+}
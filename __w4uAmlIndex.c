@@ -0,0 +1,655 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    __w4uAmlIndex.c
+
+Abstract:
+
+    AML named-object index over DSDT and all SSDTs
+
+    The AML opcode streams are scanned once, on first use, for named object declarations:
+    Scope, Device, Processor, PowerResource, ThermalZone, Method, Name, Alias, Mutex, Event,
+    OperationRegion, DataRegion, Field/IndexField/BankField units and CreateXxxField.
+    Each node is stored as {parent, NameSeg}, so the memory footprint is 24 bytes per name,
+    at most W4U_AML_NAMES_MAX names. Path lookups are one hash probe per NameSeg.
+
+    NOTE: Declarations inside If/Else/While and Method bodies are not indexed.
+          An opcode that is not understood ends the scan of the enclosing scope.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <Protocol\AcpiSystemDescriptionTable.h>
+#include "LibWin324UEFI.h"
+
+#define W4U_AML_DEPTH_MAX   64                  // scope nesting limit
+
+#define AML_SCOPE_OP        0x10
+
+typedef struct tagW4UAMLNAMESTRING
+{
+    int         fRoot;                          // '\' prefix
+    uint32_t    nParent;                        // number of '^' prefixes
+    uint32_t    nSegs;                          // number of NameSegs, 0: NullName
+    uint32_t    SegPos;                         // table offset of the first NameSeg
+
+}W4UAMLNAMESTRING;
+
+typedef struct tagW4UAMLCTX
+{
+    W4UAMLINDEX*    pIndex;
+    const uint8_t*  p;                          // DSDT or SSDT
+    uint32_t        Depth;
+
+}W4UAMLCTX;
+
+static W4UAMLINDEX _w4uAmlIndex;
+
+/** __w4uAmlPkgLength()
+Synopsis
+    static uint32_t __w4uAmlPkgLength(const uint8_t* p, uint32_t pos, uint32_t end, uint32_t* pPkgEnd);
+Description
+    Decode a PkgLength, 1 to 4 bytes
+Paramters
+    const uint8_t* p    : AML
+    uint32_t pos        : PkgLength position
+    uint32_t end        : end of the enclosing package
+    uint32_t* pPkgEnd   : end of the package
+Returns
+    position after the PkgLength, 0 if malformed
+**/
+static uint32_t __w4uAmlPkgLength(const uint8_t* p, uint32_t pos, uint32_t end, uint32_t* pPkgEnd)
+{
+    uint32_t n, len, i;
+
+    if (pos >= end)
+        return 0;
+
+    n = p[pos] >> 6;
+
+    if (pos + 1 + n > end)
+        return 0;
+
+    if (0 == n)
+        len = p[pos] & 0x3F;
+    else
+    {
+        len = p[pos] & 0x0F;
+
+        for (i = 0; i < n; i++)
+            len |= (uint32_t)p[pos + 1 + i] << (4 + 8 * i);
+    }
+
+    if (len < 1 + n || len > end - pos)
+        return 0;
+
+    *pPkgEnd = pos + len;
+
+    return pos + 1 + n;
+}
+
+/** __w4uAmlNameString()
+Synopsis
+    static uint32_t __w4uAmlNameString(const uint8_t* p, uint32_t pos, uint32_t end, W4UAMLNAMESTRING* pName);
+Description
+    Decode a NameString: [RootChar | ParentPrefixChar...] NameSeg | DualNamePath | MultiNamePath | NullName
+Paramters
+    const uint8_t* p            : AML
+    uint32_t pos                : NameString position
+    uint32_t end                : end of the enclosing package
+    W4UAMLNAMESTRING* pName     : decoded NameString
+Returns
+    position after the NameString, 0 if malformed
+**/
+static uint32_t __w4uAmlNameString(const uint8_t* p, uint32_t pos, uint32_t end, W4UAMLNAMESTRING* pName)
+{
+    memset(pName, 0, sizeof(W4UAMLNAMESTRING));
+
+    if (pos < end && '\\' == p[pos])
+    {
+        pName->fRoot = 1;
+        pos++;
+    }
+    else while (pos < end && '^' == p[pos])
+    {
+        pName->nParent++;
+        pos++;
+    }
+
+    if (pos >= end)
+        return 0;
+
+    switch (p[pos])
+    {
+    case 0x00:                                                      // NullName
+        pos++;
+        break;
+    case 0x2E:                                                      // DualNamePrefix
+        pName->nSegs = 2;
+        pos++;
+        break;
+    case 0x2F:                                                      // MultiNamePrefix SegCount
+        if (pos + 1 >= end)
+            return 0;
+        pName->nSegs = p[pos + 1];
+        pos += 2;
+        break;
+    default:
+        if ('_' != p[pos] && (p[pos] < 'A' || p[pos] > 'Z'))
+            return 0;                                               // no LeadNameChar
+        pName->nSegs = 1;
+        break;
+    }
+
+    pName->SegPos = pos;
+    pos += 4 * pName->nSegs;
+
+    return pos > end ? 0 : pos;
+}
+
+/** __w4uAmlSkipTermArg()
+Synopsis
+    static uint32_t __w4uAmlSkipTermArg(const uint8_t* p, uint32_t pos, uint32_t end);
+Description
+    Skip a TermArg that is a data object, a Local/Arg or a name reference.
+    Expressions, e.g. Add(), are not supported.
+Paramters
+    const uint8_t* p    : AML
+    uint32_t pos        : TermArg position
+    uint32_t end        : end of the enclosing package
+Returns
+    position after the TermArg, 0 if not supported or malformed
+**/
+static uint32_t __w4uAmlSkipTermArg(const uint8_t* p, uint32_t pos, uint32_t end)
+{
+    W4UAMLNAMESTRING Name;
+    uint32_t PkgEnd;
+
+    if (pos >= end)
+        return 0;
+
+    switch (p[pos])
+    {
+    case 0x00:                                                      // ZeroOp
+    case 0x01:                                                      // OneOp
+    case 0xFF:                                                      // OnesOp
+        return pos + 1;
+    case 0x0A:                                                      // BytePrefix
+        return pos + 2;
+    case 0x0B:                                                      // WordPrefix
+        return pos + 3;
+    case 0x0C:                                                      // DWordPrefix
+        return pos + 5;
+    case 0x0E:                                                      // QWordPrefix
+        return pos + 9;
+    case 0x0D:                                                      // StringPrefix AsciiCharList NullChar
+        for (pos++; pos < end && 0 != p[pos]; pos++)
+            ;
+        return pos < end ? pos + 1 : 0;
+    case 0x11:                                                      // BufferOp
+    case 0x12:                                                      // PackageOp
+    case 0x13:                                                      // VarPackageOp
+        return 0 == __w4uAmlPkgLength(p, pos + 1, end, &PkgEnd) ? 0 : PkgEnd;
+    case 0x5B:                                                      // RevisionOp
+        return pos + 1 < end && 0x30 == p[pos + 1] ? pos + 2 : 0;
+    default:
+        if (p[pos] >= 0x60 && p[pos] <= 0x6E)                       // Local0 ... Local7, Arg0 ... Arg6
+            return pos + 1;
+        return __w4uAmlNameString(p, pos, end, &Name);
+    }
+}
+
+/** __w4uAmlHashSlot()
+Synopsis
+    uint32_t __w4uAmlHashSlot(W4UAMLINDEX* pIndex, uint32_t Parent, uint32_t NameSeg);
+Description
+    Get the hash slot of a {Parent, NameSeg} pair, linear probing
+Paramters
+    W4UAMLINDEX* pIndex : AML index
+    uint32_t Parent     : pName[] index of the parent scope
+    uint32_t NameSeg    : NameSeg
+Returns
+    slot that holds the pair or the empty slot to insert it
+**/
+uint32_t __w4uAmlHashSlot(W4UAMLINDEX* pIndex, uint32_t Parent, uint32_t NameSeg)
+{
+    uint32_t mask = (1U << pIndex->HashBits) - 1;
+    uint32_t slot = ((NameSeg ^ (Parent * 0x85EBCA6BU)) * 0x9E3779B1U) >> (32 - pIndex->HashBits);
+
+    while (0 != pIndex->pHash[slot])
+    {
+        W4UAMLNAME* pName = &pIndex->pName[pIndex->pHash[slot] - 1];
+
+        if (Parent == pName->Parent && NameSeg == pName->NameSeg)
+            break;
+
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/** __w4uAmlAdd()
+Synopsis
+    static uint32_t __w4uAmlAdd(W4UAMLCTX* pCtx, uint32_t Parent, uint32_t NameSeg, uint16_t Opcode, uint32_t Offset);
+Description
+    Append a name, grow pName[] and the hash, if required
+Paramters
+    W4UAMLCTX* pCtx     : scan context
+    uint32_t Parent     : pName[] index of the parent scope
+    uint32_t NameSeg    : NameSeg
+    uint16_t Opcode     : declaring opcode
+    uint32_t Offset     : table offset
+Returns
+    pName[] index, W4U_AML_NONE if W4U_AML_NAMES_MAX is reached or out of memory
+**/
+static uint32_t __w4uAmlAdd(W4UAMLCTX* pCtx, uint32_t Parent, uint32_t NameSeg, uint16_t Opcode, uint32_t Offset)
+{
+    W4UAMLINDEX* pIndex = pCtx->pIndex;
+    W4UAMLNAME* pName;
+    uint32_t i;
+
+    if (pIndex->nNames == pIndex->nMax)
+    {
+        W4UAMLNAME* pNew = NULL;
+
+        if (pIndex->nMax < W4U_AML_NAMES_MAX)
+            pNew = realloc(pIndex->pName, 2 * pIndex->nMax * sizeof(W4UAMLNAME));
+
+        if (NULL == pNew)
+        {
+            pIndex->fTruncated = 1;
+            return W4U_AML_NONE;
+        }
+
+        pIndex->pName = pNew;
+        pIndex->nMax *= 2;
+    }
+
+    if (2 * (pIndex->nNames + 1) > (1U << pIndex->HashBits))
+    {
+        uint32_t* pNew = calloc((size_t)2 << pIndex->HashBits, sizeof(uint32_t));
+
+        if (NULL == pNew)
+        {
+            pIndex->fTruncated = 1;
+            return W4U_AML_NONE;
+        }
+
+        free(pIndex->pHash);
+        pIndex->pHash = pNew;
+        pIndex->HashBits++;
+
+        for (i = 1; i < pIndex->nNames; i++)                        // root pName[0] is not hashed
+            pIndex->pHash[__w4uAmlHashSlot(pIndex, pIndex->pName[i].Parent, pIndex->pName[i].NameSeg)] = i + 1;
+    }
+
+    pIndex->pHash[__w4uAmlHashSlot(pIndex, Parent, NameSeg)] = pIndex->nNames + 1;
+
+    pName = &pIndex->pName[pIndex->nNames];
+    pName->pTable = pCtx->p;
+    pName->Offset = Offset;
+    pName->Parent = Parent;
+    pName->NameSeg = NameSeg;
+    pName->Opcode = Opcode;
+    pName->Reserved = 0;
+
+    return pIndex->nNames++;
+}
+
+/** __w4uAmlDeclare()
+Synopsis
+    static uint32_t __w4uAmlDeclare(W4UAMLCTX* pCtx, uint32_t Scope, const W4UAMLNAMESTRING* pName, uint16_t Opcode, uint32_t Offset);
+Description
+    Resolve a NameString relative to Scope and declare it. Missing path prefixes are added as ScopeOp nodes.
+    A ScopeOp node is replaced by a later declaration, otherwise the first declaration wins.
+Paramters
+    W4UAMLCTX* pCtx                 : scan context
+    uint32_t Scope                  : pName[] index of the current scope
+    const W4UAMLNAMESTRING* pName   : NameString
+    uint16_t Opcode                 : declaring opcode
+    uint32_t Offset                 : table offset
+Returns
+    pName[] index, the prefix node for '\' or '^' followed by NullName,
+    W4U_AML_NONE for NullName without prefix or if the index is full
+**/
+static uint32_t __w4uAmlDeclare(W4UAMLCTX* pCtx, uint32_t Scope, const W4UAMLNAMESTRING* pName, uint16_t Opcode, uint32_t Offset)
+{
+    W4UAMLINDEX* pIndex = pCtx->pIndex;
+    uint32_t Node = pName->fRoot ? 0 : Scope, NameSeg, slot, i;
+
+    for (i = 0; i < pName->nParent; i++)
+        Node = pIndex->pName[Node].Parent;
+
+    if (0 == pName->nSegs)                                          // Scope (\), Scope (^): the prefix node itself
+        return pName->fRoot || 0 != pName->nParent ? Node : W4U_AML_NONE;
+
+    for (i = 0; i < pName->nSegs && W4U_AML_NONE != Node; i++)
+    {
+        int fLast = i == pName->nSegs - 1;
+
+        memcpy(&NameSeg, &pCtx->p[pName->SegPos + 4 * i], sizeof(NameSeg));
+
+        slot = __w4uAmlHashSlot(pIndex, Node, NameSeg);
+
+        if (0 == pIndex->pHash[slot])
+        {
+            Node = __w4uAmlAdd(pCtx, Node, NameSeg, fLast ? Opcode : AML_SCOPE_OP, Offset);
+            continue;
+        }
+
+        Node = pIndex->pHash[slot] - 1;
+
+        if (fLast && AML_SCOPE_OP == pIndex->pName[Node].Opcode && AML_SCOPE_OP != Opcode)
+        {
+            pIndex->pName[Node].pTable = pCtx->p;                   // declaration of a scope seen before
+            pIndex->pName[Node].Offset = Offset;
+            pIndex->pName[Node].Opcode = Opcode;
+        }
+    }
+
+    return Node;
+}
+
+/** __w4uAmlFieldList()
+Synopsis
+    static void __w4uAmlFieldList(W4UAMLCTX* pCtx, uint32_t pos, uint32_t end, uint32_t Scope, uint16_t Opcode);
+Description
+    Declare the NamedFields of a FieldList in the current scope
+Paramters
+    W4UAMLCTX* pCtx     : scan context
+    uint32_t pos        : FieldList position
+    uint32_t end        : end of the Field package
+    uint32_t Scope      : pName[] index of the current scope
+    uint16_t Opcode     : Field, IndexField or BankField opcode
+Returns
+    none
+**/
+static void __w4uAmlFieldList(W4UAMLCTX* pCtx, uint32_t pos, uint32_t end, uint32_t Scope, uint16_t Opcode)
+{
+    const uint8_t* p = pCtx->p;
+    W4UAMLNAMESTRING Name;
+    uint32_t PkgEnd;
+
+    while (pos < end)
+    {
+        switch (p[pos])
+        {
+        case 0x00:                                                  // ReservedField PkgLength
+            if (pos + 1 >= end)
+                return;
+            pos = pos + 2 + (p[pos + 1] >> 6);                      // PkgLength is a bit count here
+            break;
+        case 0x01:                                                  // AccessField AccessType AccessAttrib
+            pos += 3;
+            break;
+        case 0x02:                                                  // ConnectField NameString | BufferData
+            if (pos + 1 < end && 0x11 == p[pos + 1])
+                pos = 0 == __w4uAmlPkgLength(p, pos + 2, end, &PkgEnd) ? end : PkgEnd;
+            else if (0 == (pos = __w4uAmlNameString(p, pos + 1, end, &Name)))
+                return;
+            break;
+        case 0x03:                                                  // ExtendedAccessField AccessType ExtendedAccessAttrib AccessLength
+            pos += 4;
+            break;
+        default:                                                    // NamedField NameSeg PkgLength
+            if (0 == __w4uAmlNameString(p, pos, end, &Name) || 1 != Name.nSegs || Name.fRoot || 0 != Name.nParent)
+                return;
+            __w4uAmlDeclare(pCtx, Scope, &Name, Opcode, pos);
+            pos += 4;
+            if (pos < end)
+                pos = pos + 1 + (p[pos] >> 6);
+            break;
+        }
+    }
+}
+
+/** __w4uAmlScan()
+Synopsis
+    static void __w4uAmlScan(W4UAMLCTX* pCtx, uint32_t pos, uint32_t end, uint32_t Scope);
+Description
+    Scan a TermList for named object declarations, descend into Scope, Device, Processor,
+    PowerResource and ThermalZone
+Paramters
+    W4UAMLCTX* pCtx     : scan context
+    uint32_t pos        : TermList position
+    uint32_t end        : end of the TermList
+    uint32_t Scope      : pName[] index of the current scope
+Returns
+    none
+**/
+static void __w4uAmlScan(W4UAMLCTX* pCtx, uint32_t pos, uint32_t end, uint32_t Scope)
+{
+    const uint8_t* p = pCtx->p;
+    W4UAMLNAMESTRING Name;
+    uint32_t PkgEnd, Node, start, op, i;
+
+    if (pCtx->Depth >= W4U_AML_DEPTH_MAX)
+        return;
+
+    while (pos < end)
+    {
+        start = pos;
+        op = p[pos++];
+
+        if (0x5B == op)                                             // ExtOpPrefix
+        {
+            if (pos >= end)
+                return;
+            op = 0x5B00 | p[pos++];
+        }
+
+        switch (op)
+        {
+        case 0x10:                                                  // Scope
+        case 0x5B82:                                                // Device
+        case 0x5B83:                                                // Processor
+        case 0x5B84:                                                // PowerResource
+        case 0x5B85:                                                // ThermalZone
+            if (0 == (pos = __w4uAmlPkgLength(p, pos, end, &PkgEnd)) || 0 == (pos = __w4uAmlNameString(p, pos, PkgEnd, &Name)))
+                return;
+
+            Node = __w4uAmlDeclare(pCtx, Scope, &Name, (uint16_t)op, start);
+
+            if (0x5B83 == op)
+                pos += 6;                                           // ProcID PblkAddr PblkLen
+            if (0x5B84 == op)
+                pos += 3;                                           // SystemLevel ResourceOrder
+
+            if (W4U_AML_NONE != Node && pos <= PkgEnd)
+            {
+                pCtx->Depth++;
+                __w4uAmlScan(pCtx, pos, PkgEnd, Node);
+                pCtx->Depth--;
+            }
+
+            pos = PkgEnd;
+            break;
+
+        case 0x14:                                                  // Method PkgLength NameString MethodFlags TermList
+            if (0 == (pos = __w4uAmlPkgLength(p, pos, end, &PkgEnd)) || 0 == __w4uAmlNameString(p, pos, PkgEnd, &Name))
+                return;
+
+            __w4uAmlDeclare(pCtx, Scope, &Name, (uint16_t)op, start);
+            pos = PkgEnd;
+            break;
+
+        case 0x08:                                                  // Name NameString DataRefObject
+            if (0 == (pos = __w4uAmlNameString(p, pos, end, &Name)))
+                return;
+
+            __w4uAmlDeclare(pCtx, Scope, &Name, (uint16_t)op, start);
+            pos = __w4uAmlSkipTermArg(p, pos, end);
+            break;
+
+        case 0x06:                                                  // Alias NameString NameString
+            if (0 == (pos = __w4uAmlNameString(p, pos, end, &Name)) || 0 == (pos = __w4uAmlNameString(p, pos, end, &Name)))
+                return;
+
+            __w4uAmlDeclare(pCtx, Scope, &Name, (uint16_t)op, start);
+            break;
+
+        case 0x15:                                                  // External NameString ObjectType ArgumentCount
+            if (0 == (pos = __w4uAmlNameString(p, pos, end, &Name)))
+                return;
+            pos += 2;
+            break;
+
+        case 0x5B01:                                                // Mutex NameString SyncFlags
+        case 0x5B02:                                                // Event NameString
+            if (0 == (pos = __w4uAmlNameString(p, pos, end, &Name)))
+                return;
+
+            __w4uAmlDeclare(pCtx, Scope, &Name, (uint16_t)op, start);
+            pos += 0x5B01 == op ? 1 : 0;
+            break;
+
+        case 0x5B80:                                                // OperationRegion NameString RegionSpace RegionOffset RegionLen
+        case 0x5B88:                                                // DataRegion NameString TermArg TermArg TermArg
+            if (0 == (pos = __w4uAmlNameString(p, pos, end, &Name)))
+                return;
+
+            __w4uAmlDeclare(pCtx, Scope, &Name, (uint16_t)op, start);
+
+            if (0x5B80 == op)
+                pos += 1;
+
+            for (i = 0; i < 2 + (0x5B88 == op) && 0 != pos; i++)
+                pos = __w4uAmlSkipTermArg(p, pos, end);
+            break;
+
+        case 0x5B81:                                                // Field PkgLength NameString FieldFlags FieldList
+        case 0x5B86:                                                // IndexField PkgLength NameString NameString FieldFlags FieldList
+        case 0x5B87:                                                // BankField PkgLength NameString NameString BankValue FieldFlags FieldList
+            if (0 == (pos = __w4uAmlPkgLength(p, pos, end, &PkgEnd)) || 0 == (pos = __w4uAmlNameString(p, pos, PkgEnd, &Name)))
+                return;
+
+            if (0x5B81 != op)
+                pos = __w4uAmlNameString(p, pos, PkgEnd, &Name);
+
+            if (0x5B87 == op && 0 != pos)
+                pos = __w4uAmlSkipTermArg(p, pos, PkgEnd);
+
+            if (0 != pos)
+                __w4uAmlFieldList(pCtx, pos + 1, PkgEnd, Scope, (uint16_t)op);
+
+            pos = PkgEnd;
+            break;
+
+        case 0x8A:                                                  // CreateDWordField SourceBuff ByteIndex NameString
+        case 0x8B:                                                  // CreateWordField
+        case 0x8C:                                                  // CreateByteField
+        case 0x8D:                                                  // CreateBitField
+        case 0x8F:                                                  // CreateQWordField
+        case 0x5B13:                                                // CreateField SourceBuff BitIndex NumBits NameString
+            for (i = 0; i < 2 + (0x5B13 == op) && 0 != pos; i++)
+                pos = __w4uAmlSkipTermArg(p, pos, end);
+
+            if (0 == pos || 0 == (pos = __w4uAmlNameString(p, pos, end, &Name)))
+                return;
+
+            __w4uAmlDeclare(pCtx, Scope, &Name, (uint16_t)op, start);
+            break;
+
+        case 0xA0:                                                  // If
+        case 0xA1:                                                  // Else
+        case 0xA2:                                                  // While
+            if (0 == __w4uAmlPkgLength(p, pos, end, &PkgEnd))
+                return;
+            pos = PkgEnd;
+            break;
+
+        default:
+            return;                                                 // not understood, end of scope
+        }
+
+        if (0 == pos || pos > end)
+            return;
+    }
+}
+
+/** __w4uAmlIndexBuild()
+Synopsis
+    static void __w4uAmlIndexBuild(W4UAMLINDEX* pIndex);
+Description
+    Scan DSDT and all SSDTs and build the named-object index
+Paramters
+    W4UAMLINDEX* pIndex : AML index
+Returns
+    none
+**/
+static void __w4uAmlIndexBuild(W4UAMLINDEX* pIndex)
+{
+    static const uint32_t Signatures[] = { 'TDSD', 'TDSS', 'TDSP' };
+    W4UAMLCTX Ctx = { pIndex, NULL, 0 };
+    const EFI_ACPI_DESCRIPTION_HEADER* pHdr;
+    uint32_t i, Instance;
+
+    free(pIndex->pName);
+    free(pIndex->pHash);
+    memset(pIndex, 0, sizeof(W4UAMLINDEX));
+
+    pIndex->Generation = __w4uGetAcpiIndex()->Generation;
+    pIndex->nMax = 1024;
+    pIndex->HashBits = 11;
+    pIndex->pName = malloc(pIndex->nMax * sizeof(W4UAMLNAME));
+    pIndex->pHash = calloc((size_t)1 << pIndex->HashBits, sizeof(uint32_t));
+
+    if (NULL == pIndex->pName || NULL == pIndex->pHash)
+    {
+        free(pIndex->pName);                                        // out of memory, empty index
+        free(pIndex->pHash);
+        pIndex->pName = NULL;
+        pIndex->pHash = NULL;
+        pIndex->fTruncated = 1;
+        return;
+    }
+
+    memset(&pIndex->pName[0], 0, sizeof(W4UAMLNAME));               // root
+    pIndex->pName[0].Opcode = AML_SCOPE_OP;
+    pIndex->nNames = 1;
+
+    for (i = 0; i < sizeof(Signatures) / sizeof(Signatures[0]); i++)
+    {
+        for (Instance = 0; NULL != (pHdr = __w4uAcpiFindTable(Signatures[i], Instance)); Instance++)
+        {
+            if (pHdr->Length <= sizeof(EFI_ACPI_DESCRIPTION_HEADER) || pHdr->Length > W4U_ACPI_TABLE_MAX_LENGTH)
+                continue;
+
+            Ctx.p = (const uint8_t*)pHdr;
+            __w4uAmlScan(&Ctx, sizeof(EFI_ACPI_DESCRIPTION_HEADER), pHdr->Length, 0);
+        }
+    }
+}
+
+/** __w4uGetAmlIndex()
+Synopsis
+    W4UAMLINDEX* __w4uGetAmlIndex(void);
+Description
+    Get the AML named-object index, build it on first use and after a change of the ACPI tables
+Paramters
+    none
+Returns
+    pointer to the AML index, pHash == NULL if out of memory
+**/
+W4UAMLINDEX* __w4uGetAmlIndex(void)
+{
+    W4UAMLINDEX* pIndex = &_w4uAmlIndex;
+
+    if (0 == pIndex->Generation || pIndex->Generation != __w4uGetAcpiIndex()->Generation)
+        __w4uAmlIndexBuild(pIndex);
+
+    return pIndex;
+}
@@ -0,0 +1,557 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    __w4uClockSource.c
+
+Abstract:
+
+    Clock source for QueryPerformanceCounter(), QueryPerformanceFrequency(), GetTickCount64() and Sleep()
+
+    Candidates, probed once, on first use:
+        TSC         : reliable if invariant, CPUID 0x80000007 EDX[8]
+        HPET        : base address from the 'HPET' ACPI table, reliable if enabled and counting
+        ACPI PM timer: X_PM_TMR_BLK or PM_TMR_BLK from the FADT, 3.579545MHz, reliable if counting
+
+    The reliable candidate with the lowest read cost is selected, the TSC if none is reliable.
+    HPET and PM timer registers are accessed by a replaceable I/O function, see W4USetClockSourceIo(),
+    so the selection can be exercised in the UEFI Shell with simulated registers.
+
+    GetTickCount64() scales the counter by a 64.64 fixed point multiplier, precomputed on selection,
+    to milliseconds since system start: one counter read and one 64x64 multiplication, no division.
+    The system time is extrapolated the same way, in 100ns units, see __w4uClockTime(),
+    with an additional integer part, since the PM timer counts slower than 10MHz.
+    HPET and PM timer milliseconds are aligned to the TSC, that counts since reset.
+
+    24 and 32 bit counters are extended to 64 bit in software, at TPL_HIGH_LEVEL, since timer
+    notify functions read the clock too. A periodic event reads the counter twice per wrap around,
+    4.7s for a 24 bit PM timer, so no wrap around is missed while the program does not read the clock.
+
+    NOTE: the periodic event is started on a read at TPL_NOTIFY or below, a program that runs
+          above TPL_NOTIFY must read the clock at least once per wrap around
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <intrin.h>
+#include <Protocol\AcpiSystemDescriptionTable.h>
+#include <IndustryStandard\HighPrecisionEventTimerTable.h>
+#include "LibWin324UEFI.h"
+
+extern EFI_SYSTEM_TABLE* _cdegST;
+
+#define HPET_GCAP_ID_LO     0x000               // COUNT_SIZE_CAP bit 13
+#define HPET_GCAP_ID_HI     0x004               // COUNTER_CLK_PERIOD in femtoseconds
+#define HPET_GEN_CONF       0x010               // ENABLE_CNF bit 0
+#define HPET_MAIN_COUNTER   0x0F0
+#define HPET_PERIOD_MAX     100000000           // 100ns, 10MHz minimum
+
+#define PM_TIMER_FREQUENCY  3579545
+
+#define CLOCK_COST_READS    16                  // reads to measure the read cost
+#define CLOCK_WRAP_READS    2                   // periodic reads per wrap around of 24/32 bit counters
+
+typedef struct tagW4UCLOCK
+{
+    uint32_t    Source;                         // W4U_CLOCK_...
+    uint32_t    AddressSpace;                   // EFI_ACPI_2_0_SYSTEM_MEMORY or EFI_ACPI_2_0_SYSTEM_IO
+    uint64_t    Address;                        // counter register
+    uint32_t    BitWidth;                       // counter width, 24, 32 or 64
+    uint32_t    ReadCostNs;
+    uint64_t    Frequency;                      // counts per second
+
+}W4UCLOCK;
+
+static uint64_t __w4uClockIoDefault(uint32_t AddressSpace, uint64_t Address, uint32_t BitWidth);
+
+int _w4uClockSource;                            // W4U_CLOCK_..., 0: not yet selected
+uint64_t _w4uClockMsMul;                        // milliseconds per count, 64.64 fixed point
+static uint64_t _w4uClockMsBase;                // milliseconds at counter 0, since system start
+static uint64_t _w4uClock100nsInt;              // 100ns per count, integer part, non-zero below 10MHz
+static uint64_t _w4uClock100nsFrac;             // 100ns per count, fraction, 0.64 fixed point
+static uint64_t _w4uClock100nsBase;             // 100ns at counter 0, since system start
+static W4UCLOCK _w4uClock;
+static uint64_t _w4uClockLast;                  // last counter value, extended to 64 bit
+static EFI_EVENT _w4uClockEvent;                // periodic, notify function __w4uClockNotify()
+static uint64_t _w4uClockEventPeriod;           // 100ns units, 0: 64 bit counter, no event needed
+static uint64_t _w4uClockEventSet;              // period the event is programmed to
+static W4UCLOCKIO _w4uClockIo = __w4uClockIoDefault;
+
+/** __w4uClockIoDefault()
+Synopsis
+    static uint64_t __w4uClockIoDefault(uint32_t AddressSpace, uint64_t Address, uint32_t BitWidth);
+Description
+    Read a timer register, MMIO or I/O port
+Paramters
+    uint32_t AddressSpace   : EFI_ACPI_2_0_SYSTEM_MEMORY or EFI_ACPI_2_0_SYSTEM_IO
+    uint64_t Address        : register address
+    uint32_t BitWidth       : 32 or 64, I/O ports 32 only
+Returns
+    register value
+**/
+static uint64_t __w4uClockIoDefault(uint32_t AddressSpace, uint64_t Address, uint32_t BitWidth)
+{
+    if (EFI_ACPI_2_0_SYSTEM_IO == AddressSpace)
+        return __indword((unsigned short)Address);
+
+    if (64 == BitWidth)
+        return *(volatile uint64_t*)(size_t)Address;
+
+    return *(volatile uint32_t*)(size_t)Address;
+}
+
+/** __w4uClockScale()
+Synopsis
+    static uint64_t __w4uClockScale(uint64_t Frequency, uint64_t Scale);
+Description
+    Get the 64.64 fixed point multiplier (Scale << 64) / Frequency, e.g. milliseconds per count
+Paramters
+    uint64_t Frequency  : counts per second, greater than Scale
+    uint64_t Scale      : units per second, 1000 for milliseconds
+Returns
+    multiplier, the scaled value of Count is __umulh(Count, multiplier)
+**/
+static uint64_t __w4uClockScale(uint64_t Frequency, uint64_t Scale)
+{
+    uint64_t q = (uint64_t)-1 / Frequency, r = (uint64_t)-1 % Frequency + 1;   // 2^64 = q * Frequency + r
+
+    if (r == Frequency)
+        q++, r = 0;
+
+    return q * Scale + r * Scale / Frequency;
+}
+
+/** __w4uClockReadRaw()
+Synopsis
+    static uint64_t __w4uClockReadRaw(W4UCLOCK* pClock);
+Description
+    Read the counter of a clock source, not extended
+Paramters
+    W4UCLOCK* pClock    : clock source
+Returns
+    counter value
+**/
+static uint64_t __w4uClockReadRaw(W4UCLOCK* pClock)
+{
+    if (W4U_CLOCK_TSC == pClock->Source)
+        return __rdtsc();
+
+    return _w4uClockIo(pClock->AddressSpace, pClock->Address, 64 == pClock->BitWidth ? 64 : 32);
+}
+
+/** __w4uClockCheck()
+Synopsis
+    static int __w4uClockCheck(W4UCLOCK* pClock);
+Description
+    Check that a counter is counting and measure its read cost
+Paramters
+    W4UCLOCK* pClock    : clock source, ReadCostNs is set
+Returns
+    1   :   counting
+    0   :   stuck
+**/
+static int __w4uClockCheck(W4UCLOCK* pClock)
+{
+    uint64_t Mask = 64 == pClock->BitWidth ? (uint64_t)-1 : (1ULL << pClock->BitWidth) - 1;
+    uint64_t Value = __w4uClockReadRaw(pClock) & Mask, TscStart;
+    int i;
+
+    for (i = 0; i < 1000 && Value == (__w4uClockReadRaw(pClock) & Mask); i++)
+        ;
+
+    if (1000 == i)
+        return 0;
+
+    TscStart = __rdtsc();
+
+    for (i = 0; i < CLOCK_COST_READS; i++)
+        __w4uClockReadRaw(pClock);
+
+    pClock->ReadCostNs = (uint32_t)((__rdtsc() - TscStart) * 1000000000ULL / CLOCK_COST_READS / __w4uTscFrequency());
+
+    return 1;
+}
+
+/** __w4uClockNotify()
+Synopsis
+    static VOID EFIAPI __w4uClockNotify(EFI_EVENT Event, VOID* Context);
+Description
+    Periodic timer event, TPL_NOTIFY, extends a 24/32 bit counter before it wraps around
+Paramters
+    EFI_EVENT Event : event
+    VOID* Context   : not used
+Returns
+    none
+**/
+static VOID EFIAPI __w4uClockNotify(EFI_EVENT Event, VOID* Context)
+{
+    if (0 != _w4uClockSource && 64 != _w4uClock.BitWidth)
+        __w4uClockRead();
+}
+
+/** __w4uClockEventAtExit()
+Synopsis
+    static void __w4uClockEventAtExit(void);
+Description
+    Close the periodic event, the notify function is gone with the image
+Paramters
+    none
+Returns
+    none
+**/
+static void __w4uClockEventAtExit(void)
+{
+    if (NULL != _w4uClockEvent)
+        _cdegST->BootServices->CloseEvent(_w4uClockEvent);
+
+    _w4uClockEvent = NULL;
+    _w4uClockEventSet = 0;
+}
+
+/** __w4uClockEventUpdate()
+Synopsis
+    static void __w4uClockEventUpdate(EFI_TPL Tpl);
+Description
+    Start, reprogram or stop the periodic event for the selected clock source.
+    Event services are restricted to TPL_NOTIFY and below, otherwise the next read retries.
+Paramters
+    EFI_TPL Tpl : TPL of the caller
+Returns
+    none
+**/
+static void __w4uClockEventUpdate(EFI_TPL Tpl)
+{
+    EFI_BOOT_SERVICES* pBS = _cdegST->BootServices;
+    uint64_t Period = _w4uClockEventPeriod;
+
+    if (Tpl > TPL_NOTIFY)
+        return;
+
+    if (NULL == _w4uClockEvent)
+    {
+        if (0 == Period)
+            return;
+
+        if (EFI_SUCCESS != pBS->CreateEvent(EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_NOTIFY, __w4uClockNotify, NULL, &_w4uClockEvent))
+        {
+            _w4uClockEvent = NULL;
+            _w4uClockEventPeriod = 0;                               // no event, the program reads the clock
+            return;
+        }
+
+        atexit(__w4uClockEventAtExit);
+    }
+
+    if (EFI_SUCCESS == pBS->SetTimer(_w4uClockEvent, 0 == Period ? TimerCancel : TimerPeriodic, Period))
+        _w4uClockEventSet = Period;
+}
+
+/** __w4uClockProbe()
+Synopsis
+    static void __w4uClockProbe(uint32_t Source);
+Description
+    Probe TSC, HPET and ACPI PM timer and select the reliable one with the lowest read cost
+Paramters
+    uint32_t Source : W4U_CLOCK_..., 0 for automatic selection
+Returns
+    none
+**/
+static void __w4uClockProbe(uint32_t Source)
+{
+    W4UCLOCK Cand[3], Clock;
+    W4UACPIINDEX* pIndex = __w4uGetAcpiIndex();
+    EFI_ACPI_HIGH_PRECISION_EVENT_TIMER_TABLE_HEADER* pHpet = __w4uAcpiFindTable('TEPH', 0);
+    EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE* pFADT = pIndex->pFADT;
+    uint32_t i, n = 0, Period;
+    EFI_TPL Tpl;
+    int r[4];
+
+    memset(Cand, 0, sizeof(Cand));
+
+    //
+    // TSC, invariant only
+    //
+    __cpuid(r, 0x80000000);
+
+    if ((uint32_t)r[0] >= 0x80000007)
+    {
+        __cpuid(r, 0x80000007);
+
+        if (0 != (r[3] & (1 << 8)))
+        {
+            Cand[n].Source = W4U_CLOCK_TSC;
+            Cand[n].BitWidth = 64;
+            Cand[n++].Frequency = __w4uTscFrequency();
+        }
+    }
+
+    //
+    // HPET, enabled by the firmware
+    //
+    if (NULL != pHpet && pHpet->Header.Length >= sizeof(EFI_ACPI_HIGH_PRECISION_EVENT_TIMER_TABLE_HEADER)
+        && EFI_ACPI_2_0_SYSTEM_MEMORY == pHpet->BaseAddressLower32Bit.AddressSpaceId
+        && 0 != pHpet->BaseAddressLower32Bit.Address)
+    {
+        uint64_t Base = pHpet->BaseAddressLower32Bit.Address;
+
+        Period = (uint32_t)_w4uClockIo(EFI_ACPI_2_0_SYSTEM_MEMORY, Base + HPET_GCAP_ID_HI, 32);
+
+        if (0 != Period && Period <= HPET_PERIOD_MAX && 0 != (1 & _w4uClockIo(EFI_ACPI_2_0_SYSTEM_MEMORY, Base + HPET_GEN_CONF, 32)))
+        {
+            Cand[n].Source = W4U_CLOCK_HPET;
+            Cand[n].AddressSpace = EFI_ACPI_2_0_SYSTEM_MEMORY;
+            Cand[n].Address = Base + HPET_MAIN_COUNTER;
+            Cand[n].BitWidth = 0 != ((1 << 13) & _w4uClockIo(EFI_ACPI_2_0_SYSTEM_MEMORY, Base + HPET_GCAP_ID_LO, 32)) ? 64 : 32;
+            Cand[n++].Frequency = 1000000000000000ULL / Period;
+        }
+    }
+
+    //
+    // ACPI PM timer, X_PM_TMR_BLK takes precedence
+    //
+    if (NULL != pFADT)
+    {
+        if (pFADT->Header.Length >= offsetof(EFI_ACPI_2_0_FIXED_ACPI_DESCRIPTION_TABLE, XPmTmrBlk) + sizeof(EFI_ACPI_2_0_GENERIC_ADDRESS_STRUCTURE)
+            && 0 != pFADT->XPmTmrBlk.Address
+            && (EFI_ACPI_2_0_SYSTEM_MEMORY == pFADT->XPmTmrBlk.AddressSpaceId || EFI_ACPI_2_0_SYSTEM_IO == pFADT->XPmTmrBlk.AddressSpaceId))
+        {
+            Cand[n].AddressSpace = pFADT->XPmTmrBlk.AddressSpaceId;
+            Cand[n].Address = pFADT->XPmTmrBlk.Address;
+        }
+        else if (0 != pFADT->PmTmrBlk)
+        {
+            Cand[n].AddressSpace = EFI_ACPI_2_0_SYSTEM_IO;
+            Cand[n].Address = pFADT->PmTmrBlk;
+        }
+
+        if (0 != Cand[n].Address)
+        {
+            Cand[n].Source = W4U_CLOCK_PMTIMER;
+            Cand[n].BitWidth = 0 != (EFI_ACPI_2_0_TMR_VAL_EXT & pFADT->Flags) ? 32 : 24;
+            Cand[n++].Frequency = PM_TIMER_FREQUENCY;
+        }
+    }
+
+    //
+    // select: the requested or the cheapest counting source, the TSC as last resort
+    //
+    memset(&Clock, 0, sizeof(Clock));
+
+    for (i = 0; i < n; i++)
+    {
+        if (0 != Source && Source != Cand[i].Source)
+            continue;
+
+        if (!__w4uClockCheck(&Cand[i]))
+            continue;
+
+        if (0 == Clock.Source || Cand[i].ReadCostNs < Clock.ReadCostNs)
+            Clock = Cand[i];
+    }
+
+    if (0 == Clock.Source)
+    {
+        Clock.Source = W4U_CLOCK_TSC;
+        Clock.BitWidth = 64;
+        Clock.Frequency = __w4uTscFrequency();
+        __w4uClockCheck(&Clock);
+    }
+
+    //
+    // take over at TPL_HIGH_LEVEL, __w4uClockNotify() must not see a partially selected clock source
+    //
+    Tpl = _cdegST->BootServices->RaiseTPL(TPL_HIGH_LEVEL);
+
+    _w4uClock = Clock;
+    _w4uClockEventPeriod = 64 == Clock.BitWidth ? 0 : (1ULL << Clock.BitWidth) * 10000000 / Clock.Frequency / CLOCK_WRAP_READS;
+    _w4uClockLast = __w4uClockReadRaw(&_w4uClock);
+    _w4uClockMsMul = __w4uClockScale(_w4uClock.Frequency, 1000);
+    _w4uClock100nsInt = 10000000 / _w4uClock.Frequency;                        // PM timer 3.579545MHz: 2
+    _w4uClock100nsFrac = __w4uClockScale(_w4uClock.Frequency, 10000000 % _w4uClock.Frequency);
+    _w4uClockMsBase = 0;
+    _w4uClock100nsBase = 0;
+
+    if (W4U_CLOCK_TSC != _w4uClock.Source)              // continue the milliseconds and 100ns of the TSC
+    {
+        uint64_t qwTsc = __rdtsc();
+
+        _w4uClockMsBase = __umulh(qwTsc, __w4uClockScale(__w4uTscFrequency(), 1000)) - __umulh(_w4uClockLast, _w4uClockMsMul);
+        _w4uClock100nsBase = __umulh(qwTsc, __w4uClockScale(__w4uTscFrequency(), 10000000)) - (_w4uClockLast * _w4uClock100nsInt + __umulh(_w4uClockLast, _w4uClock100nsFrac));
+    }
+
+    _w4uClockSource = (int)_w4uClock.Source;
+
+    _cdegST->BootServices->RestoreTPL(Tpl);
+
+    __w4uClockEventUpdate(Tpl);
+}
+
+/** __w4uClockRead()
+Synopsis
+    uint64_t __w4uClockRead(void);
+Description
+    Read the clock source counter, extended to 64 bit
+Paramters
+    none
+Returns
+    counter value
+**/
+uint64_t __w4uClockRead(void)
+{
+    uint64_t Value;
+    EFI_TPL Tpl;
+
+    if (0 == _w4uClockSource)
+        __w4uClockProbe(0);
+
+    if (64 == _w4uClock.BitWidth)
+        return __w4uClockReadRaw(&_w4uClock);
+
+    //
+    // read and extend at once: a notify function that extends in between would otherwise
+    // be followed by this older Value, the masked difference wraps and the clock jumps a full wrap around
+    //
+    Tpl = _cdegST->BootServices->RaiseTPL(TPL_HIGH_LEVEL);
+
+    Value = __w4uClockReadRaw(&_w4uClock);
+    _w4uClockLast += (Value - _w4uClockLast) & ((1ULL << _w4uClock.BitWidth) - 1);
+    Value = _w4uClockLast;
+
+    _cdegST->BootServices->RestoreTPL(Tpl);
+
+    if (_w4uClockEventSet != _w4uClockEventPeriod)
+        __w4uClockEventUpdate(Tpl);
+
+    return Value;
+}
+
+/** __w4uClockTickCount()
+Synopsis
+    uint64_t __w4uClockTickCount(void);
+Description
+    Get the milliseconds since system start from the clock source counter
+Paramters
+    none
+Returns
+    milliseconds
+**/
+uint64_t __w4uClockTickCount(void)
+{
+    uint64_t Count = __w4uClockRead();                  // selects the clock source and _w4uClockMsMul
+
+    return __umulh(Count, _w4uClockMsMul) + _w4uClockMsBase;
+}
+
+/** __w4uClockTime()
+Synopsis
+    uint64_t __w4uClockTime(void);
+Description
+    Get the 100ns intervals since system start from the clock source counter,
+    continuous across a change of the clock source, see W4USetClockSource()
+Paramters
+    none
+Returns
+    100ns intervals
+**/
+uint64_t __w4uClockTime(void)
+{
+    uint64_t Count = __w4uClockRead();                  // selects the clock source and the 100ns multiplier
+
+    return Count * _w4uClock100nsInt + __umulh(Count, _w4uClock100nsFrac) + _w4uClock100nsBase;
+}
+
+/** __w4uClockFrequency()
+Synopsis
+    uint64_t __w4uClockFrequency(void);
+Description
+    Get the clock source frequency
+Paramters
+    none
+Returns
+    counts per second
+**/
+uint64_t __w4uClockFrequency(void)
+{
+    if (0 == _w4uClockSource)
+        __w4uClockProbe(0);
+
+    return _w4uClock.Frequency;
+}
+
+/** W4UGetClockSource()
+Synopsis
+    uint32_t W4UGetClockSource(uint64_t* pFrequency, uint32_t* pReadCostNs);
+Description
+    Get the clock source selected for QueryPerformanceCounter(), GetTickCount64() and Sleep()
+Paramters
+    uint64_t* pFrequency    : counts per second, may be NULL
+    uint32_t* pReadCostNs   : cost of one counter read in ns, may be NULL
+Returns
+    W4U_CLOCK_TSC, W4U_CLOCK_HPET or W4U_CLOCK_PMTIMER
+**/
+uint32_t W4UGetClockSource(uint64_t* pFrequency, uint32_t* pReadCostNs)
+{
+    if (0 == _w4uClockSource)
+        __w4uClockProbe(0);
+
+    if (NULL != pFrequency)
+        *pFrequency = _w4uClock.Frequency;
+
+    if (NULL != pReadCostNs)
+        *pReadCostNs = _w4uClock.ReadCostNs;
+
+    return _w4uClock.Source;
+}
+
+/** W4USetClockSource()
+Synopsis
+    BOOL W4USetClockSource(uint32_t Source);
+Description
+    Select a clock source explicitly, e.g. to compare HPET and PM timer, or restore the automatic selection.
+
+    NOTE: QueryPerformanceCounter() values taken before the change are not comparable to values taken after
+Paramters
+    uint32_t Source : W4U_CLOCK_TSC, W4U_CLOCK_HPET, W4U_CLOCK_PMTIMER or 0 for automatic selection
+Returns
+    1   :   success
+    0   :   Source not available or not counting, the TSC is selected
+**/
+BOOL W4USetClockSource(uint32_t Source)
+{
+    __w4uClockProbe(Source);
+
+    return 0 == Source || Source == _w4uClock.Source;
+}
+
+/** W4USetClockSourceIo()
+Synopsis
+    W4UCLOCKIO W4USetClockSourceIo(W4UCLOCKIO pfnIo);
+Description
+    Replace the HPET and PM timer register read function, e.g. by simulated registers in the UEFI Shell.
+    The clock source is selected again on next use.
+Paramters
+    W4UCLOCKIO pfnIo    : register read function, NULL to restore the MMIO/I/O port access
+Returns
+    previous register read function
+**/
+W4UCLOCKIO W4USetClockSourceIo(W4UCLOCKIO pfnIo)
+{
+    W4UCLOCKIO pfnPrev = _w4uClockIo;
+
+    _w4uClockIo = NULL != pfnIo ? pfnIo : __w4uClockIoDefault;
+    _w4uClockSource = 0;
+
+    return pfnPrev;
+}
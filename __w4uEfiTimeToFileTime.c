@@ -0,0 +1,61 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    __w4uEfiTimeToFileTime.c
+
+Abstract:
+
+    Convert EFI_TIME to Windows FILETIME
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdint.h>
+#include "LibWin324UEFI.h"
+
+/** __w4uEfiTimeToFileTime()
+Synopsis
+    uint64_t __w4uEfiTimeToFileTime(const void* pTime);
+Description
+    Convert EFI_TIME to FILETIME, the number of 100ns intervals since January 1, 1601 (UTC).
+    If EFI_TIME::TimeZone is specified, the local time is converted to UTC,
+    otherwise EFI_TIME is taken as UTC.
+Paramters
+    const void* pTime   : pointer to EFI_TIME to convert
+Returns
+    FILETIME value, 0 for an invalid EFI_TIME (e.g. Year == 0 for unsupported file times)
+**/
+uint64_t __w4uEfiTimeToFileTime(const void* pTime)
+{
+    const EFI_TIME* pEfiTime = pTime;
+    int64_t y, m, era, yoe, doy, doe, days, secs;
+
+    if (NULL == pEfiTime || pEfiTime->Year < 1601 || pEfiTime->Month < 1 || pEfiTime->Month > 12 || pEfiTime->Day < 1)
+        return 0ULL;
+
+    //
+    // days since 1601-01-01, proleptic gregorian calendar, 400 year eras starting March 1st
+    //
+    y = pEfiTime->Year - (pEfiTime->Month <= 2);
+    m = pEfiTime->Month;
+    era = y / 400;
+    yoe = y - era * 400;                                            // [0, 399]
+    doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + pEfiTime->Day - 1; // [0, 365]
+    doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;                    // [0, 146096]
+    days = era * 146097 + doe - 584694;                             // 584694: 0000-03-01 -> 1601-01-01
+
+    secs = days * 86400 + pEfiTime->Hour * 3600 + pEfiTime->Minute * 60 + pEfiTime->Second;
+
+    if (EFI_UNSPECIFIED_TIMEZONE != pEfiTime->TimeZone)
+        secs -= (int64_t)pEfiTime->TimeZone * 60;                  // local time -> UTC
+
+    return (uint64_t)secs * 10000000ULL + pEfiTime->Nanosecond / 100;
+}
@@ -0,0 +1,54 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    __w4uHasAvx2.c
+
+Abstract:
+
+    AVX2 detection for runtime selection of vectorized code paths
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <intrin.h>
+#include "LibWin324UEFI.h"
+
+/** __w4uHasAvx2()
+Synopsis
+    int __w4uHasAvx2(void);
+Description
+    Check AVX2 support by the CPU and YMM state enabled by the firmware in XCR0
+Paramters
+    none
+Returns
+    1   :   AVX2 usable
+    0   :   otherwise
+**/
+int __w4uHasAvx2(void)
+{
+    int r[4];
+
+    __cpuid(r, 0);
+    if (r[0] < 7)
+        return 0;
+
+    __cpuid(r, 1);
+    if (0 == (r[2] & (1 << 27)) || 0 == (r[2] & (1 << 28)))        // OSXSAVE, AVX
+        return 0;
+
+    if (6 != (_xgetbv(0) & 6))                                      // XMM and YMM state enabled
+        return 0;
+
+    __cpuidex(r, 7, 0);
+
+    return 0 != (r[1] & (1 << 5));                                  // AVX2
+}
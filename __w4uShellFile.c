@@ -0,0 +1,277 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    __w4uShellFile.c
+
+Abstract:
+
+    EFI_SHELL_PROTOCOL based file and directory access
+    for file information and directory handles
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <Protocol\SimpleFileSystem.h>
+#include <Protocol\Shell.h>
+#include "LibWin324UEFI.h"
+
+extern EFI_SYSTEM_TABLE* _cdegST;
+
+//
+// Windows file attribute without EFI_FILE_xxx counterpart, see __w4uFileInfoFromEfi()
+//
+#define FILE_ATTRIBUTE_NORMAL 0x00000080
+
+//
+// one EFI_FILE_INFO incl. a maximum length FAT file name, enough for any directory entry read
+//
+static union {
+    EFI_FILE_INFO Info;
+    uint8_t Raw[SIZE_OF_EFI_FILE_INFO + sizeof(CHAR16) * (W4U_MAX_FILENAME + 1)];
+}_w4uDirReadBuf;
+
+/** __w4uGetShellProtocol()
+Synopsis
+    void* __w4uGetShellProtocol(void);
+Description
+    Locate the EFI_SHELL_PROTOCOL once and return the cached pointer subsequently.
+Paramters
+    none
+Returns
+    pointer to EFI_SHELL_PROTOCOL or NULL if not available
+**/
+void* __w4uGetShellProtocol(void)
+{
+    static const EFI_GUID EfiShellProtocolGuid = EFI_SHELL_PROTOCOL_GUID;
+    static EFI_SHELL_PROTOCOL* pShell;
+    static int fLocated;
+
+    if (0 == fLocated)
+    {
+        fLocated = 1;
+
+        if (EFI_SUCCESS != _cdegST->BootServices->LocateProtocol((EFI_GUID*)&EfiShellProtocolGuid, NULL, (void**)&pShell))
+            pShell = NULL;
+    }
+
+    return pShell;
+}
+
+/** __w4uFileInfoFromEfi()
+Synopsis
+    static void __w4uFileInfoFromEfi(const EFI_FILE_INFO* pEfiInfo, W4UFILEINFO* pInfo);
+Description
+    Convert EFI_FILE_INFO to W4UFILEINFO.
+    NOTE: EFI_FILE_READ_ONLY, _HIDDEN, _SYSTEM, _DIRECTORY and _ARCHIVE are
+          bit-identical to FILE_ATTRIBUTE_READONLY, _HIDDEN, _SYSTEM, _DIRECTORY and _ARCHIVE,
+          none of them set is FILE_ATTRIBUTE_NORMAL
+Paramters
+    const EFI_FILE_INFO* pEfiInfo   : source
+    W4UFILEINFO* pInfo              : destination
+Returns
+    none
+**/
+static void __w4uFileInfoFromEfi(const EFI_FILE_INFO* pEfiInfo, W4UFILEINFO* pInfo)
+{
+    uint32_t i;
+
+    pInfo->CreationTime = __w4uEfiTimeToFileTime(&pEfiInfo->CreateTime);
+    pInfo->LastAccessTime = __w4uEfiTimeToFileTime(&pEfiInfo->LastAccessTime);
+    pInfo->LastWriteTime = __w4uEfiTimeToFileTime(&pEfiInfo->ModificationTime);
+    pInfo->EndOfFile = pEfiInfo->FileSize;
+    pInfo->AllocationSize = pEfiInfo->PhysicalSize;
+    pInfo->FileAttributes = (uint32_t)(pEfiInfo->Attribute & EFI_FILE_VALID_ATTR & ~EFI_FILE_RESERVED);
+
+    if (0 == pInfo->FileAttributes)
+        pInfo->FileAttributes = FILE_ATTRIBUTE_NORMAL;
+
+    for (i = 0; i < W4U_MAX_FILENAME && '\0' != pEfiInfo->FileName[i]; i++)
+        pInfo->FileName[i] = pEfiInfo->FileName[i];
+
+    pInfo->FileName[i] = '\0';
+    pInfo->FileNameLength = i;
+}
+
+/** __w4uOpenByName()
+Synopsis
+    static SHELL_FILE_HANDLE __w4uOpenByName(const char* pszPath);
+Description
+    Open a file or directory read-only by its UEFI Shell path name.
+Paramters
+    const char* pszPath : path name
+Returns
+    SHELL_FILE_HANDLE or NULL on error
+**/
+static SHELL_FILE_HANDLE __w4uOpenByName(const char* pszPath)
+{
+    EFI_SHELL_PROTOCOL* pShell = __w4uGetShellProtocol();
+    SHELL_FILE_HANDLE hFile = NULL;
+    CHAR16 wcsPath[W4U_MAX_PATH];
+    size_t i;
+
+    if (NULL == pShell || NULL == pszPath)
+        return NULL;
+
+    for (i = 0; i < W4U_MAX_PATH - 1 && '\0' != pszPath[i]; i++)
+        wcsPath[i] = (CHAR16)(unsigned char)pszPath[i];
+
+    wcsPath[i] = '\0';
+
+    if (EFI_SUCCESS != pShell->OpenFileByName(wcsPath, &hFile, EFI_FILE_MODE_READ))
+        hFile = NULL;
+
+    return hFile;
+}
+
+/** __w4uGetFileInfoByName()
+Synopsis
+    BOOL __w4uGetFileInfoByName(const char* pszPath, W4UFILEINFO* pInfo);
+Description
+    Get size, attributes and time stamps of a file or directory.
+Paramters
+    const char* pszPath : UEFI Shell path name
+    W4UFILEINFO* pInfo  : file information
+Returns
+    1   :   success
+    0   :   file not found
+**/
+BOOL __w4uGetFileInfoByName(const char* pszPath, W4UFILEINFO* pInfo)
+{
+    EFI_SHELL_PROTOCOL* pShell = __w4uGetShellProtocol();
+    SHELL_FILE_HANDLE hFile = __w4uOpenByName(pszPath);
+    EFI_FILE_INFO* pEfiInfo;
+    BOOL fRet = 0;
+
+    if (NULL != hFile)
+    {
+        pEfiInfo = pShell->GetFileInfo(hFile);
+
+        if (NULL != pEfiInfo)
+        {
+            __w4uFileInfoFromEfi(pEfiInfo, pInfo);
+            _cdegST->BootServices->FreePool(pEfiInfo);
+            fRet = 1;
+        }
+        pShell->CloseFile(hFile);
+    }
+
+    return fRet;
+}
+
+/** __w4uOpenDirectory()
+Synopsis
+    void* __w4uOpenDirectory(const char* pszPath);
+Description
+    Open a directory for enumeration.
+Paramters
+    const char* pszPath : UEFI Shell path name
+Returns
+    directory handle or NULL, if pszPath is not a directory
+**/
+void* __w4uOpenDirectory(const char* pszPath)
+{
+    EFI_SHELL_PROTOCOL* pShell = __w4uGetShellProtocol();
+    SHELL_FILE_HANDLE hDir = __w4uOpenByName(pszPath);
+    EFI_FILE_INFO* pEfiInfo;
+    BOOL fDir = 0;
+
+    if (NULL != hDir)
+    {
+        pEfiInfo = pShell->GetFileInfo(hDir);
+
+        if (NULL != pEfiInfo)
+        {
+            fDir = 0 != (EFI_FILE_DIRECTORY & pEfiInfo->Attribute);
+            _cdegST->BootServices->FreePool(pEfiInfo);
+        }
+
+        if (0 == fDir)
+        {
+            pShell->CloseFile(hDir);
+            hDir = NULL;
+        }
+    }
+
+    return hDir;
+}
+
+/** __w4uCloseDirectory()
+Synopsis
+    void __w4uCloseDirectory(void* hDir);
+Description
+    Close a directory handle from __w4uOpenDirectory()
+Paramters
+    void* hDir  : directory handle
+Returns
+    none
+**/
+void __w4uCloseDirectory(void* hDir)
+{
+    EFI_SHELL_PROTOCOL* pShell = __w4uGetShellProtocol();
+
+    if (NULL != pShell && NULL != hDir)
+        pShell->CloseFile(hDir);
+}
+
+/** __w4uRewindDirectory()
+Synopsis
+    BOOL __w4uRewindDirectory(void* hDir);
+Description
+    Restart directory enumeration with the first entry
+Paramters
+    void* hDir  : directory handle
+Returns
+    1   :   success
+    0   :   error
+**/
+BOOL __w4uRewindDirectory(void* hDir)
+{
+    EFI_SHELL_PROTOCOL* pShell = __w4uGetShellProtocol();
+
+    return NULL != pShell && EFI_SUCCESS == pShell->SetFilePosition(hDir, 0ULL);
+}
+
+/** __w4uReadDirectory()
+Synopsis
+    int __w4uReadDirectory(void* hDir, W4UFILEINFO* pInfo);
+Description
+    Read the next directory entry.
+Paramters
+    void* hDir          : directory handle
+    W4UFILEINFO* pInfo  : file information of the directory entry
+Returns
+    1   :   pInfo is valid
+    0   :   end of directory
+    -1  :   error
+**/
+int __w4uReadDirectory(void* hDir, W4UFILEINFO* pInfo)
+{
+    EFI_SHELL_PROTOCOL* pShell = __w4uGetShellProtocol();
+    UINTN size = sizeof(_w4uDirReadBuf);
+    int nRet = -1;
+
+    if (NULL != pShell && EFI_SUCCESS == pShell->ReadFile(hDir, &size, &_w4uDirReadBuf))
+    {
+        nRet = 0;
+
+        if (0 != size)
+        {
+            __w4uFileInfoFromEfi(&_w4uDirReadBuf.Info, pInfo);
+            nRet = 1;
+        }
+    }
+
+    return nRet;
+}
@@ -0,0 +1,340 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    __w4uSmbios.c
+
+Abstract:
+
+    SMBIOS structure index for the 'RSMB' firmware table provider
+
+    The SMBIOS 3.x 64 bit entry point is preferred over the SMBIOS 2.x 32 bit entry point.
+    The structure table is parsed once, on first use, into a by-type and a by-handle index
+    with precomputed string offsets. It is parsed again, if the SMBIOS configuration table event
+    was signaled or the entry point checksum or table length changed.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <Guid\SmBios.h>
+#include <IndustryStandard\SmBios.h>
+#include "LibWin324UEFI.h"
+
+#define IsEqualGUID(rguid1, rguid2) (!memcmp(rguid1, rguid2, sizeof(GUID))) //guiddef.h
+
+static W4USMBIOSINDEX _w4uSmbiosIndex;
+static int _w4uSmbiosIndexValid;
+static volatile int _w4uSmbiosIndexStale;          // set by the SMBIOS configuration table events
+
+/** __w4uSmbiosWalk()
+Synopsis
+    static uint32_t __w4uSmbiosWalk(W4USMBIOSINDEX* pIndex, int fFill, uint32_t* pnStrings);
+Description
+    Walk the SMBIOS structure table up to the type 127 end-of-table structure,
+    the end of the table or the first malformed structure, and truncate TableLength there.
+    With fFill == 0 structures and strings are counted only,
+    with fFill != 0 pIndex->pEntry[] and pIndex->pStringOffset[] are filled.
+Paramters
+    W4USMBIOSINDEX* pIndex  : SMBIOS index, pTable and TableLength are valid
+    int fFill               : fill pEntry[] and pStringOffset[]
+    uint32_t* pnStrings     : total number of strings
+Returns
+    number of structures
+**/
+static uint32_t __w4uSmbiosWalk(W4USMBIOSINDEX* pIndex, int fFill, uint32_t* pnStrings)
+{
+    const uint8_t* p = pIndex->pTable;
+    uint32_t Length = pIndex->TableLength;
+    uint32_t off = 0, s, nEntries = 0, nStrings = 0, nStr;
+
+    while (off + sizeof(SMBIOS_STRUCTURE) <= Length)
+    {
+        uint32_t len = p[off + 1];
+
+        if (len < sizeof(SMBIOS_STRUCTURE) || off + len > Length)
+            break;                                                  // malformed
+
+        //
+        // string-set: zero or more NUL terminated strings, terminated by an additional NUL
+        //
+        s = off + len;
+        nStr = 0;
+
+        if (s + 2 <= Length && 0 == p[s] && 0 == p[s + 1])
+            s += 1;                                                 // no strings, double NUL
+        else
+        {
+            while (s < Length && 0 != p[s])
+            {
+                if (fFill)
+                    pIndex->pStringOffset[nStrings + nStr] = s - off;
+
+                while (s < Length && 0 != p[s])
+                    s++;
+
+                s++;                                                // skip NUL
+                nStr++;
+            }
+        }
+
+        if (s >= Length)
+            break;                                                  // truncated
+
+        if (fFill)
+        {
+            W4USMBIOSENTRY* pEntry = &pIndex->pEntry[nEntries];
+
+            pEntry->pStruct = &p[off];
+            pEntry->Size = s + 1 - off;
+            pEntry->Type = p[off];
+            pEntry->Handle = (uint16_t)(p[off + 2] | p[off + 3] << 8);
+            pEntry->nStrings = (uint8_t)(nStr > 255 ? 255 : nStr);
+            pEntry->FirstString = nStrings;
+        }
+
+        nEntries++;
+        nStrings += nStr;
+
+        if (127 == p[off])
+        {
+            off = s + 1;
+            break;                                                  // end-of-table
+        }
+
+        off = s + 1;
+    }
+
+    pIndex->TableLength = off;                                      // SMBIOS 3.x: TableMaximumSize is an upper limit only
+
+    *pnStrings = nStrings;
+
+    return nEntries;
+}
+
+/** __w4uSmbiosHandleSlot()
+Synopsis
+    uint32_t __w4uSmbiosHandleSlot(W4USMBIOSINDEX* pIndex, uint16_t Handle);
+Description
+    Get the hash slot of a structure handle, linear probing
+Paramters
+    W4USMBIOSINDEX* pIndex  : SMBIOS index
+    uint16_t Handle         : structure handle
+Returns
+    slot that holds Handle or the empty slot to insert Handle
+**/
+uint32_t __w4uSmbiosHandleSlot(W4USMBIOSINDEX* pIndex, uint16_t Handle)
+{
+    uint32_t mask = (1U << pIndex->HandleHashBits) - 1;
+    uint32_t slot = ((uint32_t)Handle * 0x9E3779B1U) >> (32 - pIndex->HandleHashBits);
+
+    while (0 != pIndex->pHandleHash[slot] && Handle != pIndex->pEntry[pIndex->pHandleHash[slot] - 1].Handle)
+        slot = (slot + 1) & mask;
+
+    return slot;
+}
+
+/** __w4uSmbiosStamp()
+Synopsis
+    static uint64_t __w4uSmbiosStamp(const void* pEntryPoint, int fSmbios3);
+Description
+    Get the generation stamp of the SMBIOS entry point: checksum and table length
+Paramters
+    const void* pEntryPoint : SMBIOS 3.x or 2.x entry point
+    int fSmbios3            : SMBIOS 3.x entry point
+Returns
+    stamp
+**/
+static uint64_t __w4uSmbiosStamp(const void* pEntryPoint, int fSmbios3)
+{
+    const SMBIOS_TABLE_3_0_ENTRY_POINT* pEntryPoint3 = pEntryPoint;
+    const SMBIOS_TABLE_ENTRY_POINT* pEntryPoint2 = pEntryPoint;
+
+    if (fSmbios3)
+        return (uint64_t)pEntryPoint3->EntryPointStructureChecksum << 32 | pEntryPoint3->TableMaximumSize;
+
+    return (uint64_t)pEntryPoint2->IntermediateChecksum << 32 | pEntryPoint2->TableLength;
+}
+
+/** __w4uSmbiosIndexBuild()
+Synopsis
+    static void __w4uSmbiosIndexBuild(W4USMBIOSINDEX* pIndex);
+Description
+    Locate the SMBIOS entry point and build the structure index
+Paramters
+    W4USMBIOSINDEX* pIndex  : SMBIOS index
+Returns
+    none
+**/
+static void __w4uSmbiosIndexBuild(W4USMBIOSINDEX* pIndex)
+{
+    static const EFI_GUID SmbiosTableGuid = SMBIOS_TABLE_GUID;
+    static const EFI_GUID Smbios3TableGuid = SMBIOS3_TABLE_GUID;
+    SMBIOS_TABLE_ENTRY_POINT* pEntryPoint = NULL;
+    SMBIOS_TABLE_3_0_ENTRY_POINT* pEntryPoint3 = NULL;
+    EFI_CONFIGURATION_TABLE* pConfigTable;
+    uint32_t i, n, nStrings, slot, First, nConfigEntries;
+
+    free(pIndex->pEntry);
+    free(pIndex->pStringOffset);
+    free(pIndex->pTypeOrder);
+    free(pIndex->pHandleHash);
+    memset(pIndex, 0, sizeof(W4USMBIOSINDEX));
+
+    pConfigTable = __w4uGetConfigurationTable(&nConfigEntries);
+
+    for (i = 0; i < nConfigEntries; i++)
+    {
+        if (IsEqualGUID(&Smbios3TableGuid, &pConfigTable[i].VendorGuid))
+            pEntryPoint3 = pConfigTable[i].VendorTable;
+
+        if (IsEqualGUID(&SmbiosTableGuid, &pConfigTable[i].VendorGuid))
+            pEntryPoint = pConfigTable[i].VendorTable;
+    }
+
+    if (NULL != pEntryPoint3)
+    {
+        pIndex->pTable = (void*)(size_t)pEntryPoint3->TableAddress;
+        pIndex->TableLength = pEntryPoint3->TableMaximumSize;
+        pIndex->MajorVersion = pEntryPoint3->MajorVersion;
+        pIndex->MinorVersion = pEntryPoint3->MinorVersion;
+        pIndex->DmiRevision = pEntryPoint3->DocRev;
+        pIndex->fSmbios3 = 1;
+        pIndex->pEntryPoint = pEntryPoint3;
+    }
+    else if (NULL != pEntryPoint)
+    {
+        pIndex->pTable = (void*)(size_t)pEntryPoint->TableAddress;
+        pIndex->TableLength = pEntryPoint->TableLength;
+        pIndex->MajorVersion = pEntryPoint->MajorVersion;
+        pIndex->MinorVersion = pEntryPoint->MinorVersion;
+        pIndex->DmiRevision = pEntryPoint->EntryPointRevision;
+        pIndex->pEntryPoint = pEntryPoint;
+    }
+
+    if (NULL != pIndex->pEntryPoint)
+        pIndex->Stamp = __w4uSmbiosStamp(pIndex->pEntryPoint, pIndex->fSmbios3);
+
+    if (NULL == pIndex->pTable)
+        return;
+
+    //
+    // count, allocate, fill
+    //
+    n = __w4uSmbiosWalk(pIndex, 0, &nStrings);
+
+    for (pIndex->HandleHashBits = 4; (1U << pIndex->HandleHashBits) < 2 * n; pIndex->HandleHashBits++)
+        ;
+
+    pIndex->pEntry = malloc(sizeof(W4USMBIOSENTRY) * (n + 1));
+    pIndex->pStringOffset = malloc(sizeof(uint32_t) * (nStrings + 1));
+    pIndex->pTypeOrder = malloc(sizeof(uint32_t) * (n + 1));
+    pIndex->pHandleHash = calloc((size_t)1 << pIndex->HandleHashBits, sizeof(uint32_t));
+
+    if (NULL == pIndex->pEntry || NULL == pIndex->pStringOffset || NULL == pIndex->pTypeOrder || NULL == pIndex->pHandleHash)
+    {
+        free(pIndex->pEntry);                                       // out of memory, table view only, no index
+        free(pIndex->pStringOffset);
+        free(pIndex->pTypeOrder);
+        free(pIndex->pHandleHash);
+        pIndex->pEntry = NULL;
+        pIndex->pStringOffset = NULL;
+        pIndex->pTypeOrder = NULL;
+        pIndex->pHandleHash = NULL;
+        return;
+    }
+
+    pIndex->nEntries = __w4uSmbiosWalk(pIndex, 1, &nStrings);
+
+    //
+    // by-type: count per type, assign consecutive pTypeOrder[] ranges, then fill them
+    // by-handle: open addressing hash, linear probing
+    //
+    for (i = 0; i < pIndex->nEntries; i++)
+        pIndex->CountOfType[pIndex->pEntry[i].Type]++;
+
+    for (First = 0, i = 0; i < 256; i++)
+    {
+        pIndex->FirstOfType[i] = First;
+        First += pIndex->CountOfType[i];
+        pIndex->CountOfType[i] = 0;
+    }
+
+    for (i = 0; i < pIndex->nEntries; i++)
+    {
+        uint8_t Type = pIndex->pEntry[i].Type;
+
+        pIndex->pTypeOrder[pIndex->FirstOfType[Type] + pIndex->CountOfType[Type]++] = i;
+
+        slot = __w4uSmbiosHandleSlot(pIndex, pIndex->pEntry[i].Handle);
+
+        if (0 == pIndex->pHandleHash[slot])
+            pIndex->pHandleHash[slot] = i + 1;                      // first structure wins on duplicate handles
+    }
+}
+
+/** __w4uGetSmbiosIndex()
+Synopsis
+    W4USMBIOSINDEX* __w4uGetSmbiosIndex(void);
+Description
+    Get the SMBIOS structure index, build it on first use, rebuild it after a change
+Paramters
+    none
+Returns
+    pointer to the SMBIOS index, pTable == NULL if SMBIOS is not available
+**/
+W4USMBIOSINDEX* __w4uGetSmbiosIndex(void)
+{
+    W4USMBIOSINDEX* pIndex = &_w4uSmbiosIndex;
+
+    if (0 == _w4uSmbiosIndexValid
+        || _w4uSmbiosIndexStale
+        || (NULL != pIndex->pEntryPoint && pIndex->Stamp != __w4uSmbiosStamp(pIndex->pEntryPoint, pIndex->fSmbios3)))
+    {
+        _w4uSmbiosIndexStale = 0;                                   // before the rebuild, don't miss a new event
+        __w4uSmbiosIndexBuild(pIndex);
+        _w4uSmbiosIndexValid = 1;
+    }
+
+    return pIndex;
+}
+
+/** __w4uSmbiosIndexReset()
+Synopsis
+    void __w4uSmbiosIndexReset(void);
+Description
+    Discard the SMBIOS structure index, it is rebuilt on next use
+Paramters
+    none
+Returns
+    none
+**/
+void __w4uSmbiosIndexReset(void)
+{
+    _w4uSmbiosIndexValid = 0;
+}
+
+/** __w4uSmbiosIndexInvalidate()
+Synopsis
+    void __w4uSmbiosIndexInvalidate(void);
+Description
+    Mark the SMBIOS structure index stale, it is rebuilt on next use
+Paramters
+    none
+Returns
+    none
+**/
+void __w4uSmbiosIndexInvalidate(void)
+{
+    _w4uSmbiosIndexStale = 1;
+}
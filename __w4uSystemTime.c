@@ -0,0 +1,113 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    __w4uSystemTime.c
+
+Abstract:
+
+    Current system time as FILETIME, the real time clock extrapolated by the clock source
+
+    The RTC is read once, on first use, and anchored to the 100ns count of the clock source,
+    see __w4uClockTime(). Later reads are extrapolated from the anchor, no RTC access,
+    100ns resolution.
+
+    Every 60s the RTC is read again, to bound the drift of the clock source frequency.
+    An RTC with 1s resolution only brackets the true time: the extrapolation is kept
+    within [RTC, RTC + 1s), so the sub-second phase improves with each re-anchor.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdint.h>
+#include "LibWin324UEFI.h"
+
+extern EFI_SYSTEM_TABLE* _cdegST;
+
+#define ANCHOR_INTERVAL 600000000ULL            // 60s in 100ns units
+#define RTC_SECOND      10000000ULL             // 1s in 100ns units
+
+static uint64_t _w4uAnchorFileTime;             // 0: not anchored
+static uint64_t _w4uAnchorClock;                // __w4uClockTime() at the anchor
+static int16_t _w4uAnchorTimeZone = EFI_UNSPECIFIED_TIMEZONE;
+
+/** __w4uGetSystemFileTime()
+Synopsis
+    uint64_t __w4uGetSystemFileTime(void);
+Description
+    Get the current system time, e.g. for GetSystemTimePreciseAsFileTime() and
+    absolute due times of SetWaitableTimer()
+Paramters
+    none
+Returns
+    FILETIME value, the number of 100ns intervals since January 1, 1601 (UTC), 0 on RTC failure
+**/
+uint64_t __w4uGetSystemFileTime(void)
+{
+    uint64_t qwClock = __w4uClockTime(), qwTime, qwRtc;
+    EFI_TIME Time;
+    EFI_TIME_CAPABILITIES Capabilities;
+
+    if (0 == _w4uAnchorFileTime || qwClock - _w4uAnchorClock >= ANCHOR_INTERVAL)
+    {
+        qwTime = _w4uAnchorFileTime + (qwClock - _w4uAnchorClock);  // extrapolated, if anchored
+        qwRtc = 0;
+        Capabilities.Resolution = 1;
+
+        if (EFI_SUCCESS == _cdegST->RuntimeServices->GetTime(&Time, &Capabilities))
+            qwRtc = __w4uEfiTimeToFileTime(&Time);
+
+        if (0 == qwRtc)
+        {
+            if (0 == _w4uAnchorFileTime)
+                return 0;                                           // never anchored
+
+            qwRtc = qwTime;                                         // keep extrapolating, retry next interval
+        }
+        else
+            _w4uAnchorTimeZone = Time.TimeZone;
+
+        if (0 != _w4uAnchorFileTime && Capabilities.Resolution <= 1)
+        {
+            if (qwTime < qwRtc)                                     // true time within [RTC, RTC + 1s)
+                qwTime = qwRtc;
+            else if (qwTime >= qwRtc + RTC_SECOND)
+                qwTime = qwRtc + RTC_SECOND - 1;
+        }
+        else
+            qwTime = qwRtc;                                         // first anchor or sub-second RTC
+
+        _w4uAnchorFileTime = qwTime;
+        _w4uAnchorClock = qwClock;
+    }
+
+    return _w4uAnchorFileTime + (qwClock - _w4uAnchorClock);
+}
+
+/** __w4uGetLocalFileTime()
+Synopsis
+    uint64_t __w4uGetLocalFileTime(void);
+Description
+    Get the current local time, the system time shifted by the RTC time zone,
+    the inverse of __w4uEfiTimeToFileTime(). Without time zone, the RTC is taken as UTC.
+Paramters
+    none
+Returns
+    local FILETIME value, 0 on RTC failure
+**/
+uint64_t __w4uGetLocalFileTime(void)
+{
+    uint64_t qwTime = __w4uGetSystemFileTime();
+
+    if (0 == qwTime || EFI_UNSPECIFIED_TIMEZONE == _w4uAnchorTimeZone)
+        return qwTime;
+
+    return qwTime + (int64_t)_w4uAnchorTimeZone * 60 * RTC_SECOND;
+}
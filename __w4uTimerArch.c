@@ -0,0 +1,135 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    __w4uTimerArch.c
+
+Abstract:
+
+    Access to the EFI_TIMER_ARCH_PROTOCOL, the timer interrupt that drives UEFI timer events
+
+    The timer interrupt period can be lowered, e.g. by timeBeginPeriod(), the firmware period
+    is restored at exit.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <Protocol\Timer.h>
+#include "LibWin324UEFI.h"
+
+extern EFI_SYSTEM_TABLE* _cdegST;
+
+#define TIMER_PERIOD_DEFAULT    100000          // 10ms in 100ns units, DXE core default
+
+static UINT64 _w4uTimerPeriodFirmware;          // 0: not changed
+
+/** __w4uGetTimerArchProtocol()
+Synopsis
+    void* __w4uGetTimerArchProtocol(void);
+Description
+    Locate the EFI_TIMER_ARCH_PROTOCOL, once
+Paramters
+    none
+Returns
+    pointer to EFI_TIMER_ARCH_PROTOCOL or NULL if not available
+**/
+void* __w4uGetTimerArchProtocol(void)
+{
+    static const EFI_GUID EfiTimerArchProtocolGuid = EFI_TIMER_ARCH_PROTOCOL_GUID;
+    static EFI_TIMER_ARCH_PROTOCOL* pTimer;
+    static int fLocated;
+
+    if (0 == fLocated)
+    {
+        fLocated = 1;
+
+        if (EFI_SUCCESS != _cdegST->BootServices->LocateProtocol((EFI_GUID*)&EfiTimerArchProtocolGuid, NULL, (void**)&pTimer))
+            pTimer = NULL;
+    }
+
+    return pTimer;
+}
+
+/** __w4uTimerPeriod()
+Synopsis
+    uint64_t __w4uTimerPeriod(void);
+Description
+    Get the timer interrupt period, the resolution of UEFI timer events
+Paramters
+    none
+Returns
+    period in 100ns units, 10ms if the EFI_TIMER_ARCH_PROTOCOL is not available
+**/
+uint64_t __w4uTimerPeriod(void)
+{
+    EFI_TIMER_ARCH_PROTOCOL* pTimer = __w4uGetTimerArchProtocol();
+    UINT64 Period = 0;
+
+    if (NULL == pTimer || EFI_SUCCESS != pTimer->GetTimerPeriod(pTimer, &Period) || 0 == Period)
+        Period = TIMER_PERIOD_DEFAULT;
+
+    return Period;
+}
+
+/** __w4uTimerPeriodAtExit()
+Synopsis
+    static void __w4uTimerPeriodAtExit(void);
+Description
+    Restore the firmware timer interrupt period
+Paramters
+    none
+Returns
+    none
+**/
+static void __w4uTimerPeriodAtExit(void)
+{
+    __w4uTimerSetPeriod(0);
+}
+
+/** __w4uTimerSetPeriod()
+Synopsis
+    BOOL __w4uTimerSetPeriod(uint64_t Period);
+Description
+    Set the timer interrupt period, not above the firmware period.
+    The firmware period is saved on the first change and restored at exit.
+Paramters
+    uint64_t Period : period in 100ns units, 0 to restore the firmware period
+Returns
+    1   :   success
+    0   :   EFI_TIMER_ARCH_PROTOCOL not available or period not supported by the timer hardware
+**/
+BOOL __w4uTimerSetPeriod(uint64_t Period)
+{
+    EFI_TIMER_ARCH_PROTOCOL* pTimer = __w4uGetTimerArchProtocol();
+
+    if (NULL == pTimer)
+        return 0;
+
+    if (0 == _w4uTimerPeriodFirmware)
+    {
+        if (0 == Period)
+            return 1;                                           // not changed
+
+        if (EFI_SUCCESS != pTimer->GetTimerPeriod(pTimer, &_w4uTimerPeriodFirmware) || 0 == _w4uTimerPeriodFirmware)
+        {
+            _w4uTimerPeriodFirmware = 0;
+            return 0;                                           // timer interrupt disabled, keep it
+        }
+
+        atexit(__w4uTimerPeriodAtExit);
+    }
+
+    if (0 == Period || Period > _w4uTimerPeriodFirmware)
+        Period = _w4uTimerPeriodFirmware;
+
+    return EFI_SUCCESS == pTimer->SetTimerPeriod(pTimer, Period);
+}
@@ -0,0 +1,388 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    __w4uTimerWheel.c
+
+Abstract:
+
+    Hierarchical timer wheel for waitable timers and timeSetEvent(), driven by one
+    periodic UEFI timer event, independent of the number of timers
+
+        level 0: 256 slots of 1ms
+        level 1:  64 slots of 256ms
+        level 2:  64 slots of 16.4s
+        level 3:  64 slots of 17.5min, later expiry is cascaded again
+
+    Arm and cancel are O(1): a node is linked into the slot of its expiry. Nodes of a
+    higher level slot are cascaded to lower levels, when level 0 wraps around.
+    Time is the millisecond count of the clock source, see __w4uClockTickCount().
+
+    The periodic event runs only while nodes are armed, its notify function runs
+    expired nodes at TPL_CALLBACK, then signals the wake event for __w4uWheelWait().
+
+    NOTE: the wheel functions must be called at TPL_CALLBACK or below
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <intrin.h>
+#include "LibWin324UEFI.h"
+
+extern EFI_SYSTEM_TABLE* _cdegST;
+
+#define WHEEL_BITS0     8                       // level 0
+#define WHEEL_BITS      6                       // level 1 ... W4U_WHEEL_LEVELS - 1
+#define WHEEL_SLOTS0    (1 << WHEEL_BITS0)
+#define WHEEL_SLOTS     (1 << WHEEL_BITS)
+#define WHEEL_SPAN      (1ULL << (WHEEL_BITS0 + (W4U_WHEEL_LEVELS - 1) * WHEEL_BITS))
+#define WHEEL_TICK      10000                   // 1ms in 100ns units, periodic event
+
+static W4UWHEELNODE _w4uWheel0[WHEEL_SLOTS0];
+static W4UWHEELNODE _w4uWheelN[W4U_WHEEL_LEVELS - 1][WHEEL_SLOTS];
+static int _w4uWheelInit;
+static int _w4uWheelRunning;                    // __w4uWheelRun() is not reentrant
+static uint64_t _w4uWheelBase;                  // next millisecond to process
+static uint32_t _w4uWheelArmed;                 // number of armed nodes
+static EFI_EVENT _w4uWheelEvent;                // periodic, notify function __w4uWheelNotify()
+static EFI_EVENT _w4uWheelWake;                 // signaled after nodes expired
+
+/** __w4uWheelLink()
+Synopsis
+    static void __w4uWheelLink(W4UWHEELNODE* pNode);
+Description
+    Link a node into the slot of its expiry
+Paramters
+    W4UWHEELNODE* pNode : node, Expires is set
+Returns
+    none
+**/
+static void __w4uWheelLink(W4UWHEELNODE* pNode)
+{
+    uint64_t Expires = pNode->Expires < _w4uWheelBase ? _w4uWheelBase : pNode->Expires;
+    uint64_t Delta = Expires - _w4uWheelBase;
+    W4UWHEELNODE* pHead;
+    int i;
+
+    if (Delta < WHEEL_SLOTS0)
+        pHead = &_w4uWheel0[Expires & (WHEEL_SLOTS0 - 1)];
+    else
+    {
+        for (i = 0; i < W4U_WHEEL_LEVELS - 2 && Delta >= 1ULL << (WHEEL_BITS0 + (i + 1) * WHEEL_BITS); i++)
+            ;
+
+        if (Delta >= WHEEL_SPAN)
+            Expires = _w4uWheelBase + WHEEL_SPAN - 1;   // cascaded again, linked by the true expiry then
+
+        pHead = &_w4uWheelN[i][(Expires >> (WHEEL_BITS0 + i * WHEEL_BITS)) & (WHEEL_SLOTS - 1)];
+    }
+
+    pNode->pNext = pHead;
+    pNode->pPrev = pHead->pPrev;
+    pHead->pPrev->pNext = pNode;
+    pHead->pPrev = pNode;
+}
+
+/** __w4uWheelUnlink()
+Synopsis
+    static void __w4uWheelUnlink(W4UWHEELNODE* pNode);
+Description
+    Unlink a node from its slot
+Paramters
+    W4UWHEELNODE* pNode : linked node
+Returns
+    none
+**/
+static void __w4uWheelUnlink(W4UWHEELNODE* pNode)
+{
+    pNode->pPrev->pNext = pNode->pNext;
+    pNode->pNext->pPrev = pNode->pPrev;
+    pNode->pNext = NULL;
+    pNode->pPrev = NULL;
+}
+
+/** __w4uWheelCascade()
+Synopsis
+    static uint32_t __w4uWheelCascade(int Level);
+Description
+    Move the nodes of the current slot of a level 1 ... W4U_WHEEL_LEVELS - 1 to lower levels
+Paramters
+    int Level   : 0 ... W4U_WHEEL_LEVELS - 2, index into _w4uWheelN[]
+Returns
+    slot index, 0 if the next level is due as well
+**/
+static uint32_t __w4uWheelCascade(int Level)
+{
+    uint32_t Index = (uint32_t)(_w4uWheelBase >> (WHEEL_BITS0 + Level * WHEEL_BITS)) & (WHEEL_SLOTS - 1);
+    W4UWHEELNODE* pHead = &_w4uWheelN[Level][Index];
+    W4UWHEELNODE* pNode;
+
+    while (pHead->pNext != pHead)
+    {
+        pNode = pHead->pNext;
+        __w4uWheelUnlink(pNode);
+        __w4uWheelLink(pNode);
+    }
+
+    return Index;
+}
+
+/** __w4uWheelRun()
+Synopsis
+    static void __w4uWheelRun(void);
+Description
+    Advance the wheel to the current millisecond and run the expired nodes.
+    An expire function may arm and cancel nodes, including its own.
+Paramters
+    none
+Returns
+    none
+**/
+static void __w4uWheelRun(void)
+{
+    uint64_t Now = __w4uClockTickCount();
+    W4UWHEELNODE* pHead, * pNode;
+    int fExpired = 0, i;
+
+    if (0 != _w4uWheelRunning)
+        return;
+
+    _w4uWheelRunning = 1;
+
+    while (_w4uWheelBase <= Now && 0 != _w4uWheelArmed)
+    {
+        pHead = &_w4uWheel0[_w4uWheelBase & (WHEEL_SLOTS0 - 1)];
+
+        if (pHead == &_w4uWheel0[0])                        // level 0 wraps around
+            for (i = 0; i < W4U_WHEEL_LEVELS - 1 && 0 == __w4uWheelCascade(i); i++)
+                ;
+
+        _w4uWheelBase++;
+
+        while (pHead->pNext != pHead)
+        {
+            pNode = pHead->pNext;
+            __w4uWheelUnlink(pNode);
+            _w4uWheelArmed--;
+            fExpired = 1;
+            pNode->pfnExpire(pNode);
+        }
+    }
+
+    if (0 == _w4uWheelArmed && NULL != _w4uWheelEvent)
+        _cdegST->BootServices->SetTimer(_w4uWheelEvent, TimerCancel, 0);
+
+    _w4uWheelRunning = 0;
+
+    if (0 != fExpired && NULL != _w4uWheelWake)
+        _cdegST->BootServices->SignalEvent(_w4uWheelWake);
+}
+
+/** __w4uWheelNotify()
+Synopsis
+    static VOID EFIAPI __w4uWheelNotify(EFI_EVENT Event, VOID* Context);
+Description
+    Periodic timer event, TPL_CALLBACK
+Paramters
+    EFI_EVENT Event : event
+    VOID* Context   : not used
+Returns
+    none
+**/
+static VOID EFIAPI __w4uWheelNotify(EFI_EVENT Event, VOID* Context)
+{
+    __w4uWheelRun();
+}
+
+/** __w4uWheelAtExit()
+Synopsis
+    static void __w4uWheelAtExit(void);
+Description
+    Close the wheel events, the notify function and armed nodes are gone with the image
+Paramters
+    none
+Returns
+    none
+**/
+static void __w4uWheelAtExit(void)
+{
+    if (NULL != _w4uWheelEvent)
+        _cdegST->BootServices->CloseEvent(_w4uWheelEvent);
+
+    if (NULL != _w4uWheelWake)
+        _cdegST->BootServices->CloseEvent(_w4uWheelWake);
+
+    _w4uWheelEvent = NULL;
+    _w4uWheelWake = NULL;
+}
+
+/** __w4uWheelStart()
+Synopsis
+    static void __w4uWheelStart(void);
+Description
+    Initialize the slots and create the wheel events, once. Without events,
+    the wheel is advanced by __w4uWheelWait() only.
+Paramters
+    none
+Returns
+    none
+**/
+static void __w4uWheelStart(void)
+{
+    EFI_BOOT_SERVICES* pBS = _cdegST->BootServices;
+    int i, j;
+
+    _w4uWheelInit = 1;
+
+    for (i = 0; i < WHEEL_SLOTS0; i++)
+        _w4uWheel0[i].pNext = _w4uWheel0[i].pPrev = &_w4uWheel0[i];
+
+    for (i = 0; i < W4U_WHEEL_LEVELS - 1; i++)
+        for (j = 0; j < WHEEL_SLOTS; j++)
+            _w4uWheelN[i][j].pNext = _w4uWheelN[i][j].pPrev = &_w4uWheelN[i][j];
+
+    if (EFI_SUCCESS != pBS->CreateEvent(EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_CALLBACK, __w4uWheelNotify, NULL, &_w4uWheelEvent))
+        _w4uWheelEvent = NULL;
+
+    if (EFI_SUCCESS != pBS->CreateEvent(0, 0, NULL, NULL, &_w4uWheelWake))
+        _w4uWheelWake = NULL;
+
+    atexit(__w4uWheelAtExit);
+}
+
+/** __w4uWheelLock()
+Synopsis
+    size_t __w4uWheelLock(void);
+Description
+    Raise the TPL to TPL_CALLBACK, to exclude the wheel notify function and expire functions
+Paramters
+    none
+Returns
+    previous TPL, for __w4uWheelUnlock()
+**/
+size_t __w4uWheelLock(void)
+{
+    return _cdegST->BootServices->RaiseTPL(TPL_CALLBACK);
+}
+
+/** __w4uWheelUnlock()
+Synopsis
+    void __w4uWheelUnlock(size_t Tpl);
+Description
+    Restore the TPL
+Paramters
+    size_t Tpl  : TPL returned by __w4uWheelLock()
+Returns
+    none
+**/
+void __w4uWheelUnlock(size_t Tpl)
+{
+    _cdegST->BootServices->RestoreTPL(Tpl);
+}
+
+/** __w4uWheelArm()
+Synopsis
+    void __w4uWheelArm(W4UWHEELNODE* pNode, uint64_t qwExpires);
+Description
+    Arm a node, cancel it first if already armed. pfnExpire runs at TPL_CALLBACK
+    at the first timer interrupt at or after qwExpires.
+Paramters
+    W4UWHEELNODE* pNode : node, pfnExpire and Context are set
+    uint64_t qwExpires  : expiry, milliseconds of __w4uClockTickCount()
+Returns
+    none
+**/
+void __w4uWheelArm(W4UWHEELNODE* pNode, uint64_t qwExpires)
+{
+    size_t Tpl = __w4uWheelLock();
+
+    if (0 == _w4uWheelInit)
+        __w4uWheelStart();
+
+    if (NULL != pNode->pPrev)
+    {
+        __w4uWheelUnlink(pNode);
+        _w4uWheelArmed--;
+    }
+
+    if (0 == _w4uWheelArmed && 0 == _w4uWheelRunning)
+        _w4uWheelBase = __w4uClockTickCount();          // idle wheel, skip the past
+
+    pNode->Expires = qwExpires;
+    __w4uWheelLink(pNode);
+
+    if (0 == _w4uWheelArmed++ && NULL != _w4uWheelEvent)
+        _cdegST->BootServices->SetTimer(_w4uWheelEvent, TimerPeriodic, WHEEL_TICK);
+
+    __w4uWheelUnlock(Tpl);
+}
+
+/** __w4uWheelCancel()
+Synopsis
+    void __w4uWheelCancel(W4UWHEELNODE* pNode);
+Description
+    Cancel a node, if armed
+Paramters
+    W4UWHEELNODE* pNode : node
+Returns
+    none
+**/
+void __w4uWheelCancel(W4UWHEELNODE* pNode)
+{
+    size_t Tpl;
+
+    if (NULL == pNode->pPrev)
+        return;
+
+    Tpl = __w4uWheelLock();
+
+    if (NULL != pNode->pPrev)
+    {
+        __w4uWheelUnlink(pNode);
+
+        if (0 == --_w4uWheelArmed && 0 == _w4uWheelRunning && NULL != _w4uWheelEvent)
+            _cdegST->BootServices->SetTimer(_w4uWheelEvent, TimerCancel, 0);
+    }
+
+    __w4uWheelUnlock(Tpl);
+}
+
+/** __w4uWheelWait()
+Synopsis
+    void __w4uWheelWait(void);
+Description
+    Wait until nodes expired. At TPL_APPLICATION the CPU halts in WaitForEvent(),
+    above, or without wheel events, the wheel is advanced directly.
+    NOTE: may return early, the caller checks its condition again
+Paramters
+    none
+Returns
+    none
+**/
+void __w4uWheelWait(void)
+{
+    EFI_BOOT_SERVICES* pBS = _cdegST->BootServices;
+    EFI_TPL Tpl = pBS->RaiseTPL(TPL_HIGH_LEVEL);
+    UINTN Index;
+
+    pBS->RestoreTPL(Tpl);
+
+    if (TPL_APPLICATION == Tpl && NULL != _w4uWheelEvent && NULL != _w4uWheelWake)
+        pBS->WaitForEvent(1, &_w4uWheelWake, &Index);
+    else
+    {
+        Tpl = __w4uWheelLock();
+        __w4uWheelRun();
+        __w4uWheelUnlock(Tpl);
+        _mm_pause();
+    }
+}
@@ -0,0 +1,203 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    __w4uTrace.c
+
+Abstract:
+
+    File I/O trace recorder for CreateFile(), ReadFile(), WriteFile(), SetFilePointer()
+    and CloseHandle()
+
+    The trace is recorded to a RAM buffer and written to a file with W4UTraceStop() or at exit,
+    so that recording doesn't disturb the I/O pattern under investigation.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <intrin.h>
+#include "LibWin324UEFI.h"
+
+void* _w4uTraceBuf;                             // NULL: tracing disabled
+static size_t _w4uTraceBufSize;
+static size_t _w4uTraceBufUsed;
+static uint32_t _w4uTraceLost;
+static char* _w4uTraceFile;
+
+/** __w4uTraceTimestamp()
+Synopsis
+    uint64_t __w4uTraceTimestamp(void);
+Description
+    Get the time stamp for trace records
+Paramters
+    none
+Returns
+    TSC
+**/
+uint64_t __w4uTraceTimestamp(void)
+{
+    return __rdtsc();
+}
+
+/** __w4uTraceRecord()
+Synopsis
+    void __w4uTraceRecord(uint8_t Op, W4UFILE* pw4uFile, uint32_t Size, uint64_t Offset, uint64_t Result, uint64_t TscStart, const char* pszPath);
+Description
+    Append a trace record to the RAM buffer. Called by the file I/O functions if _w4uTraceBuf != NULL
+Paramters
+    uint8_t Op          : W4UTRACE_CREATE ... W4UTRACE_CLOSE
+    W4UFILE* pw4uFile   : handle
+    uint32_t Size       : see W4UTRACE_xyz
+    uint64_t Offset     : see W4UTRACE_xyz
+    uint64_t Result     : see W4UTRACE_xyz
+    uint64_t TscStart   : TSC at function entry
+    const char* pszPath : path name for W4UTRACE_CREATE, NULL otherwise
+Returns
+    none
+**/
+void __w4uTraceRecord(uint8_t Op, W4UFILE* pw4uFile, uint32_t Size, uint64_t Offset, uint64_t Result, uint64_t TscStart, const char* pszPath)
+{
+    uint64_t TscEnd = __rdtsc();
+    size_t lenPath = NULL == pszPath ? 0 : strlen(pszPath) + 1;
+    size_t nRecs = 1 + (lenPath + sizeof(W4UTRACEREC) - 1) / sizeof(W4UTRACEREC);
+    W4UTRACEREC* pRec;
+
+    if (NULL == _w4uTraceBuf)
+        return;
+
+    if (_w4uTraceBufUsed + nRecs * sizeof(W4UTRACEREC) > _w4uTraceBufSize)
+    {
+        _w4uTraceLost++;                        // buffer overflow, count lost records only
+        return;
+    }
+
+    pRec = (W4UTRACEREC*)((uint8_t*)_w4uTraceBuf + _w4uTraceBufUsed);
+
+    pRec->Op = Op;
+    pRec->Reserved = 0;
+    pRec->Handle = (uint16_t)(NULL == pw4uFile || (void*)-1 == pw4uFile ? 0xFFFF : pw4uFile - &_w4uiobuf[0]);
+    pRec->Size = Size;
+    pRec->Offset = Offset;
+    pRec->Result = Result;
+    pRec->TscStart = TscStart;
+    pRec->TscEnd = TscEnd;
+
+    if (0 != lenPath)
+    {
+        memset(&pRec[1], 0, (nRecs - 1) * sizeof(W4UTRACEREC));
+        memcpy(&pRec[1], pszPath, lenPath);
+    }
+
+    _w4uTraceBufUsed += nRecs * sizeof(W4UTRACEREC);
+}
+
+/** W4UTraceStop()
+Synopsis
+    BOOL W4UTraceStop(void);
+Description
+    Stop recording and write the trace file.
+Paramters
+    none
+Returns
+    1   :   success
+    0   :   tracing not started or trace file write error
+**/
+BOOL W4UTraceStop(void)
+{
+    W4UTRACEHDR Hdr = { W4UTRACE_SIGNATURE, W4UTRACE_VERSION, sizeof(W4UTRACEREC) };
+    void* pBuf = _w4uTraceBuf;
+    FILE* fp;
+    BOOL fRet = 0;
+
+    if (NULL == pBuf)
+        return 0;
+
+    _w4uTraceBuf = NULL;                        // stop recording, don't trace the trace file
+
+    Hdr.NumRecs = (uint32_t)(_w4uTraceBufUsed / sizeof(W4UTRACEREC));
+    Hdr.NumLost = _w4uTraceLost;
+    Hdr.TscPerSec = __w4uTscFrequency();        // time stamps are TSC, independent of the clock source
+
+    fp = fopen(_w4uTraceFile, "wb");
+
+    if (NULL != fp)
+    {
+        fRet = 1 == fwrite(&Hdr, sizeof(Hdr), 1, fp)
+            && _w4uTraceBufUsed == fwrite(pBuf, 1, _w4uTraceBufUsed, fp);
+        fRet = (0 == fclose(fp)) && fRet;
+    }
+
+    free(pBuf);
+    free(_w4uTraceFile);
+    _w4uTraceFile = NULL;
+
+    return fRet;
+}
+
+/** __w4uTraceAtExit()
+Synopsis
+    static void __w4uTraceAtExit(void);
+Description
+    Write the trace file at exit, if not yet done by W4UTraceStop()
+Paramters
+    none
+Returns
+    none
+**/
+static void __w4uTraceAtExit(void)
+{
+    W4UTraceStop();
+}
+
+/** W4UTraceStart()
+Synopsis
+    BOOL W4UTraceStart(size_t BufferSize, const char* pszTraceFile);
+Description
+    Start recording of file I/O to a RAM buffer of BufferSize bytes.
+    The trace is written to pszTraceFile by W4UTraceStop() or at exit.
+    Each call takes sizeof(W4UTRACEREC) == 40 bytes, CreateFile() additionally its path name.
+Paramters
+    size_t BufferSize           : size of the RAM buffer
+    const char* pszTraceFile    : trace file name
+Returns
+    1   :   success
+    0   :   already started or out of memory
+**/
+BOOL W4UTraceStart(size_t BufferSize, const char* pszTraceFile)
+{
+    static int fAtExit;
+
+    if (NULL != _w4uTraceBuf || NULL == pszTraceFile || BufferSize < sizeof(W4UTRACEREC))
+        return 0;
+
+    _w4uTraceFile = _strdup(pszTraceFile);
+    _w4uTraceBufSize = BufferSize - BufferSize % sizeof(W4UTRACEREC);
+    _w4uTraceBufUsed = 0;
+    _w4uTraceLost = 0;
+
+    if (NULL == _w4uTraceFile)
+        return 0;
+
+    if (0 == fAtExit)
+        fAtExit = 0 == atexit(__w4uTraceAtExit);
+
+    _w4uTraceBuf = malloc(_w4uTraceBufSize);    // start recording
+
+    if (NULL == _w4uTraceBuf)
+    {
+        free(_w4uTraceFile);
+        _w4uTraceFile = NULL;
+    }
+
+    return NULL != _w4uTraceBuf;
+}
@@ -0,0 +1,243 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    __w4uTranslatePath.c
+
+Abstract:
+
+    Translate Windows path names to UEFI Shell path names
+
+    C:\work\x.asl           -> fs0:\work\x.asl
+    \\?\C:\work\.\x.asl     -> fs0:\work\x.asl
+    D:/work/sub/../x.asl    -> fs1:\work\x.asl
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <Protocol\Shell.h>
+#include "LibWin324UEFI.h"
+
+#define W4U_DRIVEMAP_MAX 16                     // max. length of a shell mapping name, e.g. "fs0:"
+
+static char _w4uDriveMap['Z' - 'A' + 1][W4U_DRIVEMAP_MAX];
+static int _w4uDriveMapInitialized;
+
+/** __w4uInitDriveMap()
+Synopsis
+    static void __w4uInitDriveMap(void);
+Description
+    Assign the file system mappings fs0:, fs1: ... of the UEFI Shell to drive letters C:, D: ...
+    The EFI_SHELL_PROTOCOL is queried only once, the result is kept in _w4uDriveMap[].
+    Drive letters assigned by W4USetDriveMapping() before are not overwritten.
+Paramters
+    none
+Returns
+    none
+**/
+static void __w4uInitDriveMap(void)
+{
+    EFI_SHELL_PROTOCOL* pShell = __w4uGetShellProtocol();
+    CHAR16 wcsMap[W4U_DRIVEMAP_MAX];
+    char szMap[W4U_DRIVEMAP_MAX];
+    int fs, drv, i;
+
+    _w4uDriveMapInitialized = 1;
+
+    if (NULL == pShell)
+        return;
+
+    for (fs = 0, drv = 'C' - 'A'; drv <= 'Z' - 'A'; fs++, drv++)
+    {
+        snprintf(szMap, sizeof(szMap), "fs%d:", fs);
+
+        for (i = 0; '\0' != (wcsMap[i] = (CHAR16)szMap[i]); i++)
+            ;
+
+        if (NULL == pShell->GetDevicePathFromMap(wcsMap))
+            break;                                  // no more file system mappings
+
+        if ('\0' == _w4uDriveMap[drv][0])
+            strcpy(_w4uDriveMap[drv], szMap);
+    }
+}
+
+/** W4USetDriveMapping()
+Synopsis
+    BOOL W4USetDriveMapping(char chDrive, const char* pszMapping);
+Description
+    Assign a UEFI Shell mapping to a Windows drive letter, e.g. W4USetDriveMapping('D', "fs2:").
+    pszMapping == NULL removes the drive letter.
+Paramters
+    char chDrive            : drive letter 'A'..'Z' or 'a'..'z'
+    const char* pszMapping  : shell mapping name including the trailing colon
+Returns
+    1   :   success
+    0   :   invalid parameter
+**/
+BOOL W4USetDriveMapping(char chDrive, const char* pszMapping)
+{
+    int drv = toupper((unsigned char)chDrive) - 'A';
+    size_t len = NULL == pszMapping ? 0 : strlen(pszMapping);
+
+    if (drv < 0 || drv > 'Z' - 'A' || len >= W4U_DRIVEMAP_MAX || (0 != len && ':' != pszMapping[len - 1]))
+        return 0;
+
+    if (0 == len)
+        _w4uDriveMap[drv][0] = '\0';
+    else {
+        size_t i;
+        for (i = 0; i <= len; i++)
+            _w4uDriveMap[drv][i] = (char)tolower((unsigned char)pszMapping[i]);
+    }
+
+    return 1;
+}
+
+/** __w4uTranslatePath()
+Synopsis
+    DWORD __w4uTranslatePath(const char* pszPath, char* pszBuffer, size_t BufferSize);
+Description
+    Translate a Windows path name into its canonical UEFI Shell form:
+        1. strip \\?\ and \\.\ prefixes
+        2. replace drive letters by their shell mapping
+        3. convert '/' to '\', remove duplicate separators, "." and ".." elements
+    Path names already in UEFI Shell form (fs0:\...) are canonicalized only.
+Paramters
+    const char* pszPath : Windows path name
+    char* pszBuffer     : output buffer
+    size_t BufferSize   : size of output buffer, W4U_MAX_PATH recommended
+Returns
+    ERROR_SUCCESS               : success
+    ERROR_BAD_PATHNAME          : UNC path or unmapped drive letter
+    ERROR_FILENAME_EXCED_RANGE  : pszBuffer too small
+**/
+DWORD __w4uTranslatePath(const char* pszPath, char* pszBuffer, size_t BufferSize)
+{
+    const char* pSrc = pszPath;
+    const char* pColon;
+    size_t len = 0, root, seg;
+    int fAbsolute = 0;
+
+    if (NULL == pszPath || NULL == pszBuffer || 0 == BufferSize)
+        return ERROR_BAD_PATHNAME;
+
+    //
+    // strip Win32 file/device namespace prefix
+    //
+    if (('\\' == pSrc[0] || '/' == pSrc[0]) && ('\\' == pSrc[1] || '/' == pSrc[1]))
+    {
+        if (('?' == pSrc[2] || '.' == pSrc[2]) && ('\\' == pSrc[3] || '/' == pSrc[3]))
+            pSrc += 4;
+        else
+            return ERROR_BAD_PATHNAME;              // \\server\share not supported
+
+        if (0 == _strnicmp(pSrc, "UNC\\", 4))
+            return ERROR_BAD_PATHNAME;
+    }
+
+    //
+    // translate drive letter, keep shell mapping
+    //
+    pColon = strchr(pSrc, ':');
+
+    if (NULL != pColon && NULL == memchr(pSrc, '\\', pColon - pSrc) && NULL == memchr(pSrc, '/', pColon - pSrc))
+    {
+        if (1 == pColon - pSrc && isalpha((unsigned char)pSrc[0]))
+        {
+            const char* pMap;
+
+            if (0 == _w4uDriveMapInitialized)
+                __w4uInitDriveMap();
+
+            pMap = _w4uDriveMap[toupper((unsigned char)pSrc[0]) - 'A'];
+
+            if ('\0' == *pMap)
+                return ERROR_BAD_PATHNAME;          // drive letter not mapped
+
+            len = strlen(pMap);
+            if (len >= BufferSize)
+                return ERROR_FILENAME_EXCED_RANGE;
+            memcpy(pszBuffer, pMap, len);
+        }
+        else
+        {
+            for (len = 0; len <= (size_t)(pColon - pSrc); len++)
+            {
+                if (len >= BufferSize)
+                    return ERROR_FILENAME_EXCED_RANGE;
+                pszBuffer[len] = (char)tolower((unsigned char)pSrc[len]);
+            }
+        }
+        pSrc = pColon + 1;
+    }
+
+    //
+    // canonicalize path elements
+    //
+    if ('\\' == *pSrc || '/' == *pSrc)
+    {
+        fAbsolute = 1;
+        if (len + 1 >= BufferSize)
+            return ERROR_FILENAME_EXCED_RANGE;
+        pszBuffer[len++] = '\\';
+    }
+    root = len;                                     // ".." never removes elements left of root
+
+    while ('\0' != *pSrc)
+    {
+        while ('\\' == *pSrc || '/' == *pSrc)
+            pSrc++;                                 // skip (duplicate) separators
+
+        for (seg = 0; '\0' != pSrc[seg] && '\\' != pSrc[seg] && '/' != pSrc[seg]; seg++)
+            ;
+
+        if (0 == seg)
+            break;
+
+        if (1 == seg && '.' == pSrc[0])
+        {
+            // "." - drop element
+        }
+        else if (2 == seg && '.' == pSrc[0] && '.' == pSrc[1] && (fAbsolute || len > root))
+        {
+            // ".." - drop previous element
+            if (len > root)
+            {
+                len--;                              // remove trailing separator
+                while (len > root && '\\' != pszBuffer[len - 1])
+                    len--;
+            }
+        }
+        else
+        {
+            if (len + seg + 1 >= BufferSize)
+                return ERROR_FILENAME_EXCED_RANGE;
+            memcpy(&pszBuffer[len], pSrc, seg);
+            len += seg;
+            pszBuffer[len++] = '\\';
+
+            if (2 == seg && '.' == pSrc[0] && '.' == pSrc[1])
+                root = len;                         // leading ".." of relative path can't be dropped
+        }
+        pSrc += seg;
+    }
+
+    if (len > root)
+        len--;                                      // remove trailing separator
+
+    pszBuffer[len] = '\0';
+
+    return ERROR_SUCCESS;
+}
@@ -0,0 +1,230 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    __w4uTscFrequency.c
+
+Abstract:
+
+    TSC frequency, determined once and cached
+
+    1. CPUID 0x15 TSC/core crystal clock ratio and crystal frequency
+    2. CPUID 0x16 processor base frequency, if CPUID 0x15 reports the ratio only or the TSC is invariant
+    3. 8254 PIT channel 2 calibration, 50ms with interrupts disabled
+
+    CPUID paths don't access the PIT at all.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <uefi.h>
+#include <stdint.h>
+#include <intrin.h>
+#include "LibWin324UEFI.h"
+
+extern void _disable(void);
+extern void _enable(void);
+
+#pragma intrinsic (_disable, _enable)
+
+#define TIMER 2
+
+static uint64_t _w4uTscFrequency;                   // TSC per second, 0: not yet determined
+static uint32_t _w4uTscSource;                      // W4U_TSC_SOURCE_...
+static uint32_t _w4uTscErrorPpm;                    // estimated error in ppm
+
+/** __w4uTscCpuid()
+Synopsis
+    static uint64_t __w4uTscCpuid(uint32_t* pSource, uint32_t* pErrorPpm);
+Description
+    Get the TSC frequency from CPUID leaf 0x15 and 0x16, Intel only
+Paramters
+    uint32_t* pSource   : W4U_TSC_SOURCE_CPUID15 or W4U_TSC_SOURCE_CPUID16
+    uint32_t* pErrorPpm : estimated error in ppm
+Returns
+    TSC per second, 0 if not enumerated
+**/
+static uint64_t __w4uTscCpuid(uint32_t* pSource, uint32_t* pErrorPpm)
+{
+    int r[4], nMaxLeaf, fInvariant;
+    uint32_t Denominator = 0, Numerator = 0, CrystalHz = 0, BaseMHz = 0;
+
+    __cpuid(r, 0);
+    nMaxLeaf = r[0];
+
+    if (0x756E6547 != r[1] || 0x6C65746E != r[2] || 0x49656E69 != r[3])
+        return 0;                                                   // "GenuineIntel" only, leaf 0x15/0x16 are reserved otherwise
+
+    __cpuid(r, 0x80000000);
+    fInvariant = 0;
+
+    if ((uint32_t)r[0] >= 0x80000007)
+    {
+        __cpuid(r, 0x80000007);
+        fInvariant = 0 != (r[3] & (1 << 8));                        // invariant TSC
+    }
+
+    if (nMaxLeaf >= 0x15)
+    {
+        __cpuid(r, 0x15);
+        Denominator = (uint32_t)r[0];
+        Numerator = (uint32_t)r[1];
+        CrystalHz = (uint32_t)r[2];
+    }
+
+    if (nMaxLeaf >= 0x16)
+    {
+        __cpuid(r, 0x16);
+        BaseMHz = (uint32_t)r[0] & 0xFFFF;
+    }
+
+    if (0 != Denominator && 0 != Numerator && 0 != CrystalHz)
+    {
+        *pSource = W4U_TSC_SOURCE_CPUID15;
+        *pErrorPpm = 0;                                             // nominal crystal frequency
+        return (uint64_t)CrystalHz * Numerator / Denominator;
+    }
+
+    //
+    // crystal not enumerated, e.g. Skylake, or no leaf 0x15: the TSC runs at the base frequency,
+    // if the TSC/crystal ratio is reported or the TSC is invariant
+    //
+    if (0 != BaseMHz && (fInvariant || (0 != Denominator && 0 != Numerator)))
+    {
+        *pSource = W4U_TSC_SOURCE_CPUID16;
+        *pErrorPpm = 500000 / BaseMHz;                              // base frequency is rounded to MHz
+        return (uint64_t)BaseMHz * 1000000;
+    }
+
+    return 0;
+}
+
+/** __w4uTscPit()
+
+    __w4uTscPit() returns the TimeStampCounter counts per second
+
+    NTSC Color Subcarrier:  f = 3.579545MHz * 4 ->
+                            f = 14.31818MHz / 12 -> 1.193181818...MHz
+    PIT 8254 input clk:     f = 1.193181818MHz
+                            f = 11931818181Hz / 59659 ->
+                            f = 20Hz -> t = 1/f
+                            t = 50ms
+                            ========
+                            50ms * 20 ->
+
+                                  1s
+                            ===============
+
+    @param[out] pErrorPpm   estimated error in ppm, 2 PIT ticks of 59659
+
+    @retval number of CPU clock per second
+
+**/
+static uint64_t __w4uTscPit(uint32_t* pErrorPpm)
+{
+    size_t eflags = __readeflags();         // save flaags
+    unsigned long long qwTSCPerTick, qwTSCEnd, qwTSCStart, qwTSCDrift;
+    unsigned char counterLoHi[2];
+    unsigned short* pwCount = (unsigned short*)&counterLoHi[0];
+    unsigned short wCountDrift;
+
+    _disable();
+
+    outp(0x61, 0);                          // stop counter
+    outp(0x43, (TIMER << 6) + 0x34);        // program timer 2 for MODE 2
+    outp(0x42, 0xFF);                       // write counter value low 65535
+    outp(0x42, 0xFF);                       // write counter value high 65535
+    outp(0x61, 1);                          // start counter
+
+    qwTSCStart = __rdtsc();                 // get TSC start
+
+    //
+    // repeat counter latch command until 50ms
+    //
+    do                                                      //
+    {                                                       //
+        outp(0x43, (TIMER << 6) + 0x0);                     // counter latch timer 2
+        counterLoHi[0] = (unsigned char)inp(0x40 + TIMER);  // get low byte
+        counterLoHi[1] = (unsigned char)inp(0x40 + TIMER);  // get high byte
+                                                            //
+    } while (*pwCount > (65535 - 59659));                   // until 59659 ticks gone
+
+    qwTSCEnd = __rdtsc();                                   // get TSC end ~50ms
+
+    *pwCount = 65535 - *pwCount;                            // get true, not inverted, number of clock ticks...
+                                                            // ... that really happened
+    wCountDrift = *pwCount - 59659;                         // get the number of additional ticks gone through
+
+    //
+    // approximate the additional number of TSC
+    //
+    qwTSCPerTick = (qwTSCEnd - qwTSCStart) / *pwCount;      // get number of CPU TSC per 8254 ClkTick (1,19MHz)
+    qwTSCDrift = wCountDrift * qwTSCPerTick;                // get TSC drift
+
+    if (0x200 & eflags)                                     // restore IF interrupt flag
+        _enable();
+
+    *pErrorPpm = 2 * 1000000 / 59659;                       // latch resolution at start and end
+
+    return 20 * (qwTSCEnd - qwTSCStart - qwTSCDrift);       // subtract the drift from TSC difference, scale to 1 second
+}
+
+/** __w4uTscFrequency()
+Synopsis
+    uint64_t __w4uTscFrequency(void);
+Description
+    Get the TSC frequency, determined on first call, see W4UGetTscFrequency()
+Paramters
+    none
+Returns
+    TSC per second
+**/
+uint64_t __w4uTscFrequency(void)
+{
+    if (0 == _w4uTscFrequency)
+    {
+        uint64_t qwFreq = __w4uTscCpuid(&_w4uTscSource, &_w4uTscErrorPpm);
+
+        if (0 == qwFreq)
+        {
+            qwFreq = __w4uTscPit(&_w4uTscErrorPpm);
+            _w4uTscSource = W4U_TSC_SOURCE_PIT;
+        }
+
+        _w4uTscFrequency = qwFreq;
+    }
+
+    return _w4uTscFrequency;
+}
+
+/** W4UGetTscFrequency()
+Synopsis
+    uint64_t W4UGetTscFrequency(uint32_t* pSource, uint32_t* pErrorPpm);
+Description
+    Get the TSC frequency, its source and estimated error. QueryPerformanceFrequency() reports it,
+    if the TSC is the clock source, see W4UGetClockSource().
+    The frequency is determined once, on first use by any caller.
+Paramters
+    uint32_t* pSource   : W4U_TSC_SOURCE_CPUID15, W4U_TSC_SOURCE_CPUID16 or W4U_TSC_SOURCE_PIT, may be NULL
+    uint32_t* pErrorPpm : estimated error in ppm, 0 for the nominal crystal frequency, may be NULL
+Returns
+    TSC per second
+**/
+uint64_t W4UGetTscFrequency(uint32_t* pSource, uint32_t* pErrorPpm)
+{
+    uint64_t qwFreq = __w4uTscFrequency();
+
+    if (NULL != pSource)
+        *pSource = _w4uTscSource;
+
+    if (NULL != pErrorPpm)
+        *pErrorPpm = _w4uTscErrorPpm;
+
+    return qwFreq;
+}
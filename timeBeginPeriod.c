@@ -0,0 +1,137 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    timeBeginPeriod.c
+
+Abstract:
+
+    Win32 API timeBeginPeriod(), timeEndPeriod() and timeGetDevCaps() for UEFI
+
+    The timer interrupt period of the EFI_TIMER_ARCH_PROTOCOL is lowered to the smallest
+    outstanding request, the resolution of Sleep(), waitable timers and timeSetEvent().
+    Requests are counted per period, the firmware period is restored with the last
+    timeEndPeriod() or at exit.
+
+    Periods up to W4U_TIME_PERIOD_MAX are accepted, as on Windows. Above 1s, far beyond
+    any firmware period, requests are counted together; __w4uTimerSetPeriod() never
+    raises the period above the firmware period, so they never change the timer.
+
+    NOTE: a shorter period means more timer interrupts, at 1ms ten times as many as at
+          the usual 10ms firmware period
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "LibWin324UEFI.h"
+
+#define TIME_PERIOD_EXACT 1000                  // periods counted one by one, above: one slot
+
+#define TIME_PERIOD_SLOT(u) ((u) > TIME_PERIOD_EXACT ? TIME_PERIOD_EXACT + 1 : (u))
+
+static uint32_t _w4uTimePeriodCount[TIME_PERIOD_EXACT + 2]; // outstanding requests per period slot
+static UINT _w4uTimePeriod;                     // slot of the smallest outstanding request, 0: none
+
+/** timeBeginPeriod()
+Synopsis
+    MMRESULT timeBeginPeriod(UINT uPeriod);
+    https://docs.microsoft.com/en-us/windows/win32/api/timeapi/nf-timeapi-timebeginperiod#syntax
+Description
+    Requests a minimum resolution for periodic timers.
+Paramters
+    https://docs.microsoft.com/en-us/windows/win32/api/timeapi/nf-timeapi-timebeginperiod#parameters
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/timeapi/nf-timeapi-timebeginperiod#return-value
+    TIMERR_NOCANDO also if the timer hardware doesn't support the period
+**/
+MMRESULT WINAPI _w4utimeBeginPeriod(_In_ UINT uPeriod)
+{
+    UINT uSlot = TIME_PERIOD_SLOT(uPeriod);
+
+    if (1 > uPeriod || W4U_TIME_PERIOD_MAX < uPeriod)
+        return TIMERR_NOCANDO;
+
+    if (0 == _w4uTimePeriod || uSlot < _w4uTimePeriod)
+    {
+        if (!__w4uTimerSetPeriod(uSlot * 10000ULL))
+            return TIMERR_NOCANDO;
+
+        _w4uTimePeriod = uSlot;
+    }
+
+    _w4uTimePeriodCount[uSlot]++;
+
+    return TIMERR_NOERROR;
+}
+
+/** timeEndPeriod()
+Synopsis
+    MMRESULT timeEndPeriod(UINT uPeriod);
+    https://docs.microsoft.com/en-us/windows/win32/api/timeapi/nf-timeapi-timeendperiod#syntax
+Description
+    Clears a previously set minimum timer resolution.
+    The next smallest outstanding request takes effect, the firmware period if none.
+Paramters
+    https://docs.microsoft.com/en-us/windows/win32/api/timeapi/nf-timeapi-timeendperiod#parameters
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/timeapi/nf-timeapi-timeendperiod#return-value
+**/
+MMRESULT WINAPI _w4utimeEndPeriod(_In_ UINT uPeriod)
+{
+    UINT uSlot = TIME_PERIOD_SLOT(uPeriod), u;
+
+    if (1 > uPeriod || W4U_TIME_PERIOD_MAX < uPeriod || 0 == _w4uTimePeriodCount[uSlot])
+        return TIMERR_NOCANDO;
+
+    if (0 == --_w4uTimePeriodCount[uSlot] && uSlot == _w4uTimePeriod)
+    {
+        for (u = uSlot + 1; u <= TIME_PERIOD_EXACT + 1 && 0 == _w4uTimePeriodCount[u]; u++)
+            ;
+
+        _w4uTimePeriod = u <= TIME_PERIOD_EXACT + 1 ? u : 0;
+
+        __w4uTimerSetPeriod(_w4uTimePeriod * 10000ULL);     // 0: firmware period
+    }
+
+    return TIMERR_NOERROR;
+}
+
+/** timeGetDevCaps()
+Synopsis
+    MMRESULT timeGetDevCaps(LPTIMECAPS ptc, UINT cbtc);
+    https://docs.microsoft.com/en-us/windows/win32/api/timeapi/nf-timeapi-timegetdevcaps#syntax
+Description
+    Queries the timer device to determine its resolution.
+
+    NOTE: without EFI_TIMER_ARCH_PROTOCOL wPeriodMin is the current timer interrupt period
+Paramters
+    https://docs.microsoft.com/en-us/windows/win32/api/timeapi/nf-timeapi-timegetdevcaps#parameters
+Returns
+    https://docs.microsoft.com/en-us/windows/win32/api/timeapi/nf-timeapi-timegetdevcaps#return-value
+**/
+MMRESULT WINAPI _w4utimeGetDevCaps(_Out_ LPTIMECAPS ptc, _In_ UINT cbtc)
+{
+    if (NULL == ptc || sizeof(TIMECAPS) > cbtc)
+        return TIMERR_NOCANDO;
+
+    ptc->wPeriodMin = 1;
+    ptc->wPeriodMax = W4U_TIME_PERIOD_MAX;
+
+    if (NULL == __w4uGetTimerArchProtocol())
+        ptc->wPeriodMin = (UINT)((__w4uTimerPeriod() + 9999) / 10000);
+
+    return TIMERR_NOERROR;
+}
+
+void* __imp_timeBeginPeriod = (void*)_w4utimeBeginPeriod;
+void* __imp_timeEndPeriod = (void*)_w4utimeEndPeriod;
+void* __imp_timeGetDevCaps = (void*)_w4utimeGetDevCaps;
@@ -0,0 +1,231 @@
+/*++
+
+Copyright (c) 2021-2025, Kilian Kegel. All rights reserved.<BR>
+
+    SPDX-License-Identifier: GNU General Public License v3.0 only
+
+Module Name:
+
+    timeSetEvent.c
+
+Abstract:
+
+    Win32 API timeSetEvent() and timeKillEvent() for UEFI
+
+    Timer events are timer wheel nodes, kept in chunks of 256 that never move.
+    The timer ID is the table index + 1 in the low word and an allocation count in the high word,
+    so a stale ID doesn't kill a reused timer.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <windows.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "LibWin324UEFI.h"
+
+#define MMTIMER_CHUNK   256                     // timers per chunk
+
+typedef struct tagW4UMMTIMER
+{
+    W4UWHEELNODE Node;
+    LPTIMECALLBACK pfnTimeProc;
+    DWORD_PTR   dwUser;
+    UINT        uDelay;
+    UINT        fuEvent;
+    UINT        uTimerID;                       // Reuse << 16 | Index, 0: free
+    uint16_t    Index;                          // table index + 1
+    uint16_t    Reuse;                          // number of allocations
+    struct tagW4UMMTIMER* pNextFree;
+
+}W4UMMTIMER;
+
+static W4UMMTIMER* _w4uMmTimerChunk[0x10000 / MMTIMER_CHUNK];
+static uint32_t _w4uMmTimerCount;               // number of timers in all chunks
+static W4UMMTIMER* _w4uMmTimerFree;
+
+/** __w4uMmTimerFind()
+Synopsis
+    static W4UMMTIMER* __w4uMmTimerFind(UINT uTimerID);
+Description
+    Get the timer of a timer ID, __w4uWheelLock() held
+Paramters
+    UINT uTimerID   : timer ID
+Returns
+    timer, NULL for an invalid or stale ID
+**/
+static W4UMMTIMER* __w4uMmTimerFind(UINT uTimerID)
+{
+    uint32_t Index = (uTimerID & 0xFFFF) - 1;
+    W4UMMTIMER* pMmTimer;
+
+    if (0 == uTimerID || Index >= _w4uMmTimerCount)
+        return NULL;
+
+    pMmTimer = &_w4uMmTimerChunk[Index / MMTIMER_CHUNK][Index % MMTIMER_CHUNK];
+
+    return uTimerID == pMmTimer->uTimerID ? pMmTimer : NULL;
+}
+
+/** __w4uMmTimerRelease()
+Synopsis
+    static void __w4uMmTimerRelease(W4UMMTIMER* pMmTimer);
+Description
+    Cancel a timer and put it to the free list, __w4uWheelLock() held
+Paramters
+    W4UMMTIMER* pMmTimer    : timer
+Returns
+    none
+**/
+static void __w4uMmTimerRelease(W4UMMTIMER* pMmTimer)
+{
+    __w4uWheelCancel(&pMmTimer->Node);
+
+    pMmTimer->uTimerID = 0;
+    pMmTimer->pNextFree = _w4uMmTimerFree;
+    _w4uMmTimerFree = pMmTimer;
+}
+
+/** __w4uMmTimerExpire()
+Synopsis
+    static void __w4uMmTimerExpire(W4UWHEELNODE* pNode);
+Description
+    Timer wheel expire function, rearm a periodic timer and call the callback function.
+    A one-shot timer is released after the callback.
+Paramters
+    W4UWHEELNODE* pNode : W4UMMTIMER::Node
+Returns
+    none
+**/
+static void __w4uMmTimerExpire(W4UWHEELNODE* pNode)
+{
+    W4UMMTIMER* pMmTimer = pNode->Context;
+    UINT uTimerID = pMmTimer->uTimerID;
+    UINT fuEvent = pMmTimer->fuEvent;
+
+    if (TIME_PERIODIC & fuEvent)
+        __w4uWheelArm(pNode, pNode->Expires + pMmTimer->uDelay);   // no drift
+
+    pMmTimer->pfnTimeProc(uTimerID, 0, pMmTimer->dwUser, 0, 0);
+
+    if (0 == (TIME_PERIODIC & fuEvent) && uTimerID == pMmTimer->uTimerID)
+        __w4uMmTimerRelease(pMmTimer);                              // not killed by the callback
+}
+
+/** timeSetEvent()
+Synopsis
+    MMRESULT timeSetEvent(
+      UINT           uDelay,
+      UINT           uResolution,
+      LPTIMECALLBACK lpTimeProc,
+      DWORD_PTR      dwUser,
+      UINT           fuEvent
+    );
+    https://docs.microsoft.com/en-us/previous-versions/dd757634(v=vs.85)#syntax
+Description
+    Starts a specified timer event.
+
+    NOTE: the callback function runs at TPL_CALLBACK in the notify function of the timer wheel,
+          not in a thread of its own
+    NOTE: uResolution is ignored, the resolution is the timer interrupt period, see timeBeginPeriod()
+    NOTE: TIME_CALLBACK_EVENT_SET and TIME_CALLBACK_EVENT_PULSE are not supported, there are no event objects
+Paramters
+    https://docs.microsoft.com/en-us/previous-versions/dd757634(v=vs.85)#parameters
+Returns
+    https://docs.microsoft.com/en-us/previous-versions/dd757634(v=vs.85)#return-value
+**/
+MMRESULT WINAPI _w4utimeSetEvent(
+    _In_ UINT uDelay,
+    _In_ UINT uResolution,
+    _In_ LPTIMECALLBACK lpTimeProc,
+    _In_ DWORD_PTR dwUser,
+    _In_ UINT fuEvent
+)
+{
+    W4UMMTIMER* pMmTimer = NULL, * pChunk;
+    UINT uTimerID = 0;
+    size_t Tpl;
+    uint32_t i;
+
+    if (0 == uDelay || W4U_TIME_PERIOD_MAX < uDelay || NULL == lpTimeProc
+        || 0 != ((TIME_CALLBACK_EVENT_SET | TIME_CALLBACK_EVENT_PULSE) & fuEvent))
+        return 0;
+
+    Tpl = __w4uWheelLock();
+
+    do {
+
+        if (NULL == _w4uMmTimerFree)                                // add a chunk to the free list
+        {
+            if (_w4uMmTimerCount >= 0x10000 - MMTIMER_CHUNK)
+                break;                                              // table index exhausted
+
+            pChunk = calloc(MMTIMER_CHUNK, sizeof(W4UMMTIMER));
+
+            if (NULL == pChunk)
+                break;
+
+            _w4uMmTimerChunk[_w4uMmTimerCount / MMTIMER_CHUNK] = pChunk;
+
+            for (i = MMTIMER_CHUNK; i-- > 0; )
+            {
+                pChunk[i].Node.pfnExpire = __w4uMmTimerExpire;
+                pChunk[i].Node.Context = &pChunk[i];
+                pChunk[i].Index = (uint16_t)(_w4uMmTimerCount + i + 1);
+                pChunk[i].pNextFree = _w4uMmTimerFree;
+                _w4uMmTimerFree = &pChunk[i];
+            }
+
+            _w4uMmTimerCount += MMTIMER_CHUNK;
+        }
+
+        pMmTimer = _w4uMmTimerFree;
+        _w4uMmTimerFree = pMmTimer->pNextFree;
+
+        pMmTimer->Reuse++;
+        pMmTimer->uTimerID = (UINT)pMmTimer->Reuse << 16 | pMmTimer->Index;
+        pMmTimer->pfnTimeProc = lpTimeProc;
+        pMmTimer->dwUser = dwUser;
+        pMmTimer->uDelay = uDelay;
+        pMmTimer->fuEvent = fuEvent;
+
+        __w4uWheelArm(&pMmTimer->Node, __w4uClockTickCount() + 1 + uDelay);  // current millisecond partly gone, never early
+
+        uTimerID = pMmTimer->uTimerID;
+
+    } while (0);
+
+    __w4uWheelUnlock(Tpl);
+
+    return uTimerID;
+}
+
+/** timeKillEvent()
+Synopsis
+    MMRESULT timeKillEvent(UINT uTimerID);
+    https://docs.microsoft.com/en-us/previous-versions/dd757630(v=vs.85)#syntax
+Description
+    Cancels a specified timer event. A callback function may kill its own timer.
+Paramters
+    https://docs.microsoft.com/en-us/previous-versions/dd757630(v=vs.85)#parameters
+Returns
+    https://docs.microsoft.com/en-us/previous-versions/dd757630(v=vs.85)#return-value
+**/
+MMRESULT WINAPI _w4utimeKillEvent(_In_ UINT uTimerID)
+{
+    size_t Tpl = __w4uWheelLock();
+    W4UMMTIMER* pMmTimer = __w4uMmTimerFind(uTimerID);
+
+    if (NULL != pMmTimer)
+        __w4uMmTimerRelease(pMmTimer);
+
+    __w4uWheelUnlock(Tpl);
+
+    return NULL != pMmTimer ? TIMERR_NOERROR : MMSYSERR_INVALPARAM;
+}
+
+void* __imp_timeSetEvent = (void*)_w4utimeSetEvent;
+void* __imp_timeKillEvent = (void*)_w4utimeKillEvent;